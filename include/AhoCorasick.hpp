@@ -0,0 +1,54 @@
+#ifndef AHO_CORASICK_HPP
+#define AHO_CORASICK_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+// Multi-pattern matcher built as a complete DFA over a reduced alphabet.
+// Bytes that occur in no pattern share one class, so the transition table
+// is a single flat array of numStates * numClasses entries.
+// Matching is case-insensitive, like the KMP and Rabin-Karp searches.
+class AhoCorasick
+{
+private:
+    vector<unsigned char> byteClass; // byte -> alphabet class (0 = not in any pattern)
+    int numClasses;
+    vector<int> transitions; // state * numClasses + class -> next state
+    vector<int> outputOffsets; // outputs of state s are outputs[outputOffsets[s] .. outputOffsets[s + 1])
+    vector<int> outputs;
+    vector<size_t> patternLengths;
+
+    void build(const vector<string> &patterns);
+
+public:
+    explicit AhoCorasick(const vector<string> &patterns);
+
+    size_t getPatternCount() const;
+    size_t getStateCount() const;
+
+    // Calls onMatch(patternId, startPosition) for every occurrence in text
+    template <typename Callback>
+    void scan(string_view text, Callback &&onMatch) const
+    {
+        int state = 0;
+        for (size_t i = 0; i < text.length(); i++)
+        {
+            state = transitions[state * numClasses + byteClass[(unsigned char)text[i]]];
+            for (int o = outputOffsets[state]; o < outputOffsets[state + 1]; o++)
+            {
+                onMatch(outputs[o], i + 1 - patternLengths[outputs[o]]);
+            }
+        }
+    }
+
+    // All occurrences as (start position, pattern id), in order of their end position
+    vector<pair<size_t, int>> search(string_view text) const;
+
+    // Sets matched[id] for every pattern that occurs in text; returns the number of newly set flags
+    size_t markMatches(string_view text, vector<char> &matched) const;
+};
+
+#endif // AHO_CORASICK_HPP
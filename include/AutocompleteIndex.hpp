@@ -0,0 +1,48 @@
+#ifndef AUTOCOMPLETE_INDEX_HPP
+#define AUTOCOMPLETE_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include "UserStore.hpp"
+#include "Graph.hpp"
+
+using namespace std;
+
+// Prefix lookup over user names. Every distinct lower-cased name is stored once in a
+// single byte buffer; the sorted key array points into it, with one key for the whole
+// name and one for each later word, so "smi" completes "John Smith". Each row is stored
+// with its vertex number, so ranking a match reads its degree without an ID lookup.
+class AutocompleteIndex
+{
+private:
+    struct Key
+    {
+        unsigned int offset; // Into nameBytes
+        unsigned int length;
+        unsigned int name;   // Distinct name number
+    };
+
+    const UserStore &users;
+    string nameBytes;
+    vector<Key> keys; // Sorted by the bytes they reference
+    vector<unsigned int> nameUserOffsets; // Rows of distinct name n: nameRows[nameUserOffsets[n] .. nameUserOffsets[n + 1])
+    vector<unsigned int> nameRows;
+    vector<int> nameVertices; // Vertex of each entry of nameRows, -1 when not in the graph
+
+    bool keyLess(const Key &a, const Key &b) const;
+
+public:
+    // Indexes the users currently in the store, which must outlive the index, with their
+    // vertex numbers in graph. Rebuild it when users are added or removed or the graph is
+    // compacted; new connections need no rebuild.
+    AutocompleteIndex(const UserStore &indexedUsers, const Graph &graph);
+
+    // Up to limit users with a name word starting with prefix (case-insensitive),
+    // highest degree in graph first, ties broken by name. graph must number its vertices
+    // as the one the index was built with.
+    vector<ConstUser> complete(const string &prefix, size_t limit, const Graph &graph) const;
+
+    size_t getDistinctNameBytes() const;
+};
+
+#endif // AUTOCOMPLETE_INDEX_HPP
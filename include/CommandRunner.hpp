@@ -0,0 +1,90 @@
+#ifndef COMMAND_RUNNER_HPP
+#define COMMAND_RUNNER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include "VersionedNetwork.hpp"
+#include "RandomWalk.hpp"
+#include "FuzzyNameIndex.hpp"
+
+using namespace std;
+
+// Executes analyzer commands without the interactive menu and reports each result as
+// one line of JSON, for scripts and batch jobs that load the network once and then run
+// many queries. Commands are words, e.g. "recommend user1" or "search name ali":
+//   load <file>                          export <file>  (.csv for CSV, JSON otherwise)
+//   recommend <id> [k]                   communities [k]  (within the k-core)
+//   distance <from-id> <to-id>           triangles [id]
+//   pagerank [k]                         betweenness [k] [samples]
+//   centrality <id>                      coreness [id]
+//   ego <id> [hops]                      (the user's neighbourhood and circles of friends)
+//   ppr <id> [k] [walks]                 (Personalized PageRank recommendations)
+//   cache-stats                          cache-warm [k]  (recommendation cache)
+//   search <name|location|interest>[:kmp|:rabin-karp|:simd] <pattern...>
+//   fuzzy <max-typos> <name...>          (typo-tolerant name search)
+//   add-user <id> <name> [age] [location] [interest...]
+//   connect <id> <id>                    disconnect <id> <id>
+//   remove-user <id>                     compact
+//   batch <command> [args] ; <command> [args] ...  (mutations published as one version)
+//   reorder <bfs|degree|rcm>             compress
+//   benchmark [sources]
+// Every result line has a "command" field, plus "error" when the command failed.
+// Queries run against one snapshot of the network and mutations commit a new version,
+// so run() may be called from several threads at once.
+class CommandRunner
+{
+private:
+    VersionedNetwork &network;
+
+    static const size_t MAX_PPR_RESULTS = 1000;
+    static const size_t MAX_PPR_WALKS = 1000000;
+
+    // Structures of the newest version queried so far, shared by concurrent commands
+    VersionCache<RandomWalkEngine> walkEngines;
+    VersionCache<FuzzyNameIndex> fuzzyNameIndexes;
+
+    // Each returns the result line or throws runtime_error with the failure message
+    string load(const vector<string> &words);
+    string exportNetwork(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string recommend(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string communities(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string distance(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string search(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string fuzzySearch(const vector<string> &words, const shared_ptr<const NetworkSnapshot> &snapshot);
+    string triangles(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string centrality(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string coreness(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string ego(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string personalizedPageRank(const vector<string> &words, const shared_ptr<const NetworkSnapshot> &snapshot);
+    string recommendationCache(const vector<string> &words, const NetworkSnapshot &snapshot);
+    string mutate(const vector<string> &words);
+    string benchmark(const vector<string> &words, const NetworkSnapshot &snapshot);
+
+public:
+    explicit CommandRunner(VersionedNetwork &versionedNetwork);
+
+    // Runs one command and returns its JSON result line (without the newline).
+    // Failures are reported in the line and through succeeded when given.
+    string run(const vector<string> &words, bool *succeeded = nullptr);
+
+    // Runs one command per input line, writing one result line each. Blank lines and
+    // lines starting with '#' are skipped. Returns the number of failed commands.
+    size_t runScript(istream &in, ostream &out);
+
+    static vector<string> splitWords(const string &line);
+
+    // Result line reporting a failed command
+    static string errorResult(string_view command, string_view message);
+
+    // Whether the command only reads the network
+    static bool isReadOnly(const string &command);
+
+    // Whether the command changes users or connections (but touches no files)
+    static bool isMutation(const string &command);
+};
+
+#endif // COMMAND_RUNNER_HPP
@@ -0,0 +1,99 @@
+#ifndef COMPRESSED_ADJACENCY_HPP
+#define COMPRESSED_ADJACENCY_HPP
+
+#include <cstddef>
+#include <vector>
+#include "CopyOnWrite.hpp"
+
+using namespace std;
+
+// Reads one LEB128 varint (7 bits per byte, high bit set on all but the last byte)
+inline const unsigned char *readVarint(const unsigned char *in, unsigned int &value)
+{
+    value = *in & 0x7f;
+    for (int shift = 7; *in++ & 0x80; shift += 7)
+    {
+        value |= (unsigned int)(*in & 0x7f) << shift;
+    }
+    return in;
+}
+
+// One vertex's neighbours, either a plain int array or a CompressedAdjacency list
+// decoded while iterating. Valid until the graph it came from is changed.
+class NeighborRange
+{
+public:
+    class iterator
+    {
+    private:
+        const int *plain;           // Next plain entry, nullptr when decoding
+        const unsigned char *bytes; // Next encoded gap
+        int value;                  // Current decoded neighbour
+        size_t remaining;
+
+        void decodeGap()
+        {
+            unsigned int gap;
+            bytes = readVarint(bytes, gap);
+            value += (int)gap + 1;
+        }
+
+    public:
+        iterator(const int *list, size_t count) : plain(list), bytes(nullptr), value(0), remaining(count) {}
+        iterator(const unsigned char *encoded, int first, size_t count)
+            : plain(nullptr), bytes(encoded), value(first), remaining(count) {}
+
+        int operator*() const { return plain ? *plain : value; }
+        iterator &operator++()
+        {
+            if (--remaining == 0)
+                return *this;
+            if (plain)
+                ++plain;
+            else
+                decodeGap();
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return remaining == other.remaining; }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    NeighborRange(const vector<int> &list) : first(list.data(), list.size()) {}
+    NeighborRange(const unsigned char *encoded, int firstNeighbor, size_t count) : first(encoded, firstNeighbor, count) {}
+
+    iterator begin() const { return first; }
+    iterator end() const { return iterator(nullptr, 0); }
+
+private:
+    iterator first;
+};
+
+// Read-only neighbour lists packed into one byte array, a few times smaller than
+// vector<vector<int>>. Each list is sorted and stored as its length, then the first
+// neighbour relative to the vertex itself (zigzag-encoded, since it may be smaller),
+// then the gaps between consecutive neighbours minus one. Every number is a varint, so
+// after a locality-improving VertexOrder most entries take one byte.
+class CompressedAdjacency
+{
+private:
+    vector<unsigned char> bytes;
+    vector<size_t> offsets; // Vertex -> start of its list; one extra entry at the end
+
+    static void appendVarint(vector<unsigned char> &out, unsigned int value);
+
+public:
+    CompressedAdjacency();
+
+    // Packs lists[v] for every vertex, leaving out removed vertices and their entries
+    void build(const ChunkedVector<vector<int>> &lists, const vector<char> &removed);
+    void clear();
+
+    size_t getVertexCount() const;
+    size_t degree(int vertex) const;
+    NeighborRange neighbors(int vertex) const;
+    bool contains(int vertex, int neighbor) const; // Stops at the first larger neighbour
+
+    size_t getBytesUsed() const;
+};
+
+#endif // COMPRESSED_ADJACENCY_HPP
@@ -0,0 +1,109 @@
+#ifndef COPY_ON_WRITE_HPP
+#define COPY_ON_WRITE_HPP
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// A value shared by copies of its holder until one of them writes to it, which then
+// gets a private copy first. Holders can live in different threads: the owner count is
+// atomic, and only a copy of a holder can add an owner, so a holder that finds itself
+// the sole owner stays so while it writes.
+template <typename T>
+class CopyOnWrite
+{
+private:
+    struct Shared
+    {
+        atomic<size_t> owners;
+        T value;
+
+        explicit Shared(T initial) : owners(1), value(move(initial)) {}
+    };
+
+    Shared *shared;
+
+public:
+    explicit CopyOnWrite(T value = T()) : shared(new Shared(move(value))) {}
+    CopyOnWrite(const CopyOnWrite &other) : shared(other.shared) { shared->owners.fetch_add(1, memory_order_relaxed); }
+    CopyOnWrite &operator=(CopyOnWrite other)
+    {
+        swap(shared, other.shared);
+        return *this;
+    }
+    ~CopyOnWrite()
+    {
+        // The acquire half orders the delete after every other owner's reads
+        if (shared->owners.fetch_sub(1, memory_order_acq_rel) == 1)
+            delete shared;
+    }
+
+    const T &operator*() const { return shared->value; }
+    const T *operator->() const { return &shared->value; }
+
+    bool isShared() const { return shared->owners.load(memory_order_acquire) > 1; }
+
+    T &write()
+    {
+        if (isShared())
+            *this = CopyOnWrite(shared->value);
+        return shared->value;
+    }
+};
+
+// Vector stored in chunks of CHUNK_SIZE elements, each a CopyOnWrite. Copying the vector
+// copies only the chunk pointers, and a write copies at most one chunk, so versions of a
+// large structure that differ in a few elements share the rest. Reads go through one
+// extra pointer.
+template <typename T>
+class ChunkedVector
+{
+private:
+    static const size_t CHUNK_BITS = 8;
+    static const size_t CHUNK_SIZE = (size_t)1 << CHUNK_BITS;
+
+    vector<CopyOnWrite<vector<T>>> chunks; // Every chunk but the last holds CHUNK_SIZE elements
+    size_t count;
+
+public:
+    ChunkedVector() : count(0) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T &operator[](size_t index) const { return (*chunks[index >> CHUNK_BITS])[index & (CHUNK_SIZE - 1)]; }
+    T &at(size_t index) { return chunks[index >> CHUNK_BITS].write()[index & (CHUNK_SIZE - 1)]; }
+
+    void push_back(T value)
+    {
+        if ((count & (CHUNK_SIZE - 1)) == 0)
+        {
+            chunks.emplace_back();
+            chunks.back().write().reserve(CHUNK_SIZE);
+        }
+        chunks.back().write().push_back(move(value));
+        count++;
+    }
+
+    // Replaces the contents with values, chunk by chunk
+    void assign(vector<T> values)
+    {
+        clear();
+        for (T &value : values)
+        {
+            push_back(move(value));
+        }
+    }
+
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+
+    size_t getChunkCount() const { return chunks.size(); }
+};
+
+#endif // COPY_ON_WRITE_HPP
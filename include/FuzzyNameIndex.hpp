@@ -0,0 +1,53 @@
+#ifndef FUZZY_NAME_INDEX_HPP
+#define FUZZY_NAME_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include "UserStore.hpp"
+#include "StringSearch.hpp"
+
+using namespace std;
+
+// Gram index over user names that prunes approximate name searches. A name containing
+// the pattern within k edits must share at least (distinct pattern bigrams - k * GRAM_LENGTH)
+// of the pattern's bigrams, so only names passing that count filter are verified with
+// Myers' algorithm. When that bound is not positive (short patterns, large k) single
+// characters are counted instead: such a name holds at least (pattern length - k) of the
+// pattern's characters, counted with repeats. Only k >= pattern length, where every
+// name matches, reads every row.
+class FuzzyNameIndex
+{
+private:
+    static const int GRAM_LENGTH = 2;
+
+    const UserStore &users;
+    size_t indexedCount;
+    unordered_map<unsigned int, vector<unsigned int>> gramPostings;      // Folded bigram -> ascending user rows
+    unordered_map<unsigned int, vector<unsigned int>> characterPostings; // characterKeys entry -> ascending user rows
+
+    // Zeroed per-row counters, one per search in flight, so a query clears only the
+    // rows it touched instead of allocating a counter per user
+    mutable mutex countersMutex;
+    mutable vector<vector<unsigned short>> spareCounters;
+
+    static vector<unsigned int> distinctGrams(string_view text);
+    // (n << 8 | c) for each folded character c and n = 1 .. its number of occurrences
+    static vector<unsigned int> characterKeys(string_view text);
+
+    // Ascending rows listed under at least threshold of the keys
+    vector<unsigned int> rowsSharing(const unordered_map<unsigned int, vector<unsigned int>> &postings,
+                                     const vector<unsigned int> &keys, int threshold) const;
+
+public:
+    // Indexes the users currently in the store, which must outlive the index
+    explicit FuzzyNameIndex(const UserStore &indexedUsers);
+
+    // Same results as StringSearch::fuzzySearchUsersByName over the indexed users
+    vector<StringSearch::FuzzyMatch> search(const string &searchPattern, int maxDistance) const;
+
+    size_t getUserCount() const;
+};
+
+#endif // FUZZY_NAME_INDEX_HPP
@@ -6,16 +6,86 @@
 #include <string>
 #include <queue>
 #include <set>
+#include <functional>
+#include "CopyOnWrite.hpp"
+#include "CompressedAdjacency.hpp"
+#include "RecommendationCache.hpp"
 
 using namespace std;
 
+// Vertex numbering chosen by Graph::compact. Traversals index per-vertex arrays by
+// neighbour number, so orders that give neighbours nearby numbers touch fewer cache lines.
+enum class VertexOrder
+{
+    BFS,                  // Breadth-first from each unvisited vertex in current order
+    DEGREE,               // Highest degree first, so hubs share the front of every array
+    REVERSE_CUTHILL_MCKEE // BFS from low-degree roots, neighbours by ascending degree, reversed
+};
+
+// Undirected friendship graph. Users are numbered 0, 1, 2, ... in insertion order and
+// the algorithms work on those vertex numbers; the string-keyed API translates IDs at
+// the boundary. Neighbour lists are unordered so an edge is deleted by swapping it
+// with the last entry. Lists longer than HUB_DEGREE also keep a neighbour -> position
+// index, which makes insert, delete and membership O(1) whatever the degree.
+//
+// Removing a user only tombstones its vertex: the entries other users' lists hold for
+// it are skipped by every traversal and purged in one batch later, after which the
+// vertex number goes on a free list for reuse. compact() renumbers the live vertices
+// densely in a VertexOrder.
+//
+// compressAdjacency() swaps the lists for a CompressedAdjacency, which traversals decode
+// as they go. It suits read-mostly graphs: the first change afterwards expands it again.
+//
+// Top-k recommendations are cached per user. A user's ranking depends only on the
+// connections of the user and of their friends, so a connection change drops just the
+// entries of its two ends and their friends.
+//
+// Copies share the neighbour lists, user IDs and ID index until they change them (see
+// CopyOnWrite.hpp), so a copy costs a pointer per 256 vertices, a byte per vertex for the
+// tombstones, the hub indexes and the cached recommendations. Copies taken while the
+// graph is compressed duplicate the packed lists.
 class Graph
 {
 private:
-    unordered_map<string, vector<string>> adjacencyList;
-    vector<vector<int>> adjacencyMatrix;
-    unordered_map<string, int> userIndices;
-    vector<string> users;
+    static const size_t HUB_DEGREE = 64;
+
+    ChunkedVector<string> users; // Vertex -> user ID
+    ChunkedVector<vector<int>> neighbors;
+
+    // User ID -> vertex. Copies of the graph share sharedIndices; while it is shared, users
+    // added since go to addedIndices and the IDs of users removed since to removedIndices,
+    // whose stale entries lookups recognise by the vertex no longer holding that ID. The
+    // changes are folded into a private copy once they reach an eighth of the shared part.
+    CopyOnWrite<unordered_map<string, int>> sharedIndices;
+    unordered_map<string, int> addedIndices;
+    vector<string> removedIndices;
+    int userCount;
+    unordered_map<int, unordered_map<int, unsigned int>> hubPositions; // Hub vertex -> neighbour -> position
+    size_t connectionCount;
+
+    vector<char> removed;     // Tombstone flag per vertex
+    vector<int> pendingPurge; // Removed vertices still referenced from other lists
+    size_t staleEntries;      // Total list length of pendingPurge
+    vector<int> freeVertices; // Purged vertices, reused by addUser
+
+    CompressedAdjacency packed; // Replaces neighbors while compressed
+    bool compressed;
+
+    mutable RecommendationCache recommendationCache; // Filled by const lookups
+
+    void indexUser(const string &userId, int vertex);
+    void unindexUser(const string &userId);
+    void ownIndices(); // Makes sharedIndices private to this graph and folds the changes into it
+    int findPosition(int vertex, int neighbor) const; // -1 when not adjacent
+    void insertNeighbor(int vertex, int neighbor);
+    void eraseNeighbor(int vertex, int neighbor);
+    void expand(); // Back to plain lists before a change
+    void rebuildHubPositions();
+    vector<int> liveDegrees() const;
+    vector<int> computeOrder(VertexOrder order) const; // Live vertices, in their new numbering
+    vector<int> rankRecommendations(int vertex, size_t k) const;
+    // Drops the cached rankings of every user within hops of vertex
+    void invalidateRecommendations(int vertex, int hops);
 
 public:
     Graph();
@@ -25,42 +95,98 @@ public:
     void addConnection(const string &user1, const string &user2);
     void removeConnection(const string &user1, const string &user2);
     bool areConnected(const string &user1, const string &user2) const;
+    int getDegree(const string &userId) const;
+
+    // Tombstones the user and drops its connections; returns false for an unknown user
+    bool removeUser(const string &userId);
+
+    // Deletes the entries neighbour lists still hold for removed users and frees their
+    // vertex numbers. Runs by itself once stale entries outnumber live ones, and before
+    // addUser would otherwise grow the graph.
+    void purgeRemoved();
+
+    // Renumbers the live users 0 .. getUserCount() - 1 in the given order, permuting every
+    // per-vertex array, and drops all tombstones
+    void compact(VertexOrder order = VertexOrder::BFS);
+
+    // Packs the neighbour lists (purging removed users first); see CompressedAdjacency
+    void compressAdjacency();
+    bool isCompressed() const;
+    size_t getAdjacencyBytes() const; // Approximate memory held by the neighbour lists
+
+    // Subgraph induced by the given users: a new, compact graph holding them (numbered in
+    // the given order, duplicates and removed or unknown users skipped) and every connection
+    // between them. The work is proportional to the members' degrees, not to the whole graph,
+    // so expensive algorithms such as floydWarshall can run on just that part.
+    Graph inducedSubgraph(const vector<int> &vertices) const;
+    Graph inducedSubgraph(const vector<string> &userIds) const;
+
+    // Induced subgraph of the users within hops of userId, which becomes vertex 0; the
+    // others follow in BFS order. Empty for an unknown user.
+    Graph egoNetwork(const string &userId, int hops = 1) const;
+
+    // Vertex-level access, vertices are 0 .. getVertexCount() - 1. getNeighbors may list
+    // removed vertices until they are purged, so traversals check isRemoved.
+    int getUserIndex(const string &userId) const; // -1 when absent
+    bool hasUser(const string &userId) const;
+    const string &getUserId(int vertex) const;
+    NeighborRange getNeighbors(int vertex) const;
+    int getDegree(int vertex) const; // 0 for a removed vertex
+    bool areConnected(int vertex1, int vertex2) const;
+    bool isRemoved(int vertex) const;
+    int getVertexCount() const;
+    bool hasTombstones() const;
 
     // Friend recommendations using BFS
     vector<string> getFriendRecommendations(const string &userId, int depth = 2) const;
 
+    // Friends of friends ranked by mutual friends (ties by user ID), at most k. Served from
+    // the recommendation cache, which a miss fills; safe to call from several threads.
+    vector<string> getTopRecommendations(const string &userId, size_t k = 10) const;
+    // Ranks every live user into the cache ahead of the lookups, in parallel
+    void warmRecommendationCache(size_t k = 10) const;
+    RecommendationCacheStats getRecommendationCacheStats() const;
+
     // BFS traversal
     vector<string> BFS(const string &startUser) const;
 
+    // Bounded BFS: calls visit(userId, hops) for every user within maxHops of startUser
+    // (excluding startUser) in order of distance. Stops as soon as visit returns false,
+    // so only the explored part of the graph is touched.
+    void boundedBFS(const string &startUser, int maxHops, const function<bool(const string &, int)> &visit) const;
+
+    // Number of hops on a shortest path between two users, or -1 when unreachable
+    int getDistance(const string &fromUser, const string &toUser) const;
+
     // DFS traversal
     vector<string> DFS(const string &startUser) const;
-    void DFSUtil(const string &user, set<string> &visited, vector<string> &result) const;
 
     // Community detection using Kruskal's algorithm
     struct Edge
     {
-        string user1;
-        string user2;
+        int user1;
+        int user2;
         int weight;
 
-        Edge(string u1, string u2, int w) : user1(u1), user2(u2), weight(w) {}
+        Edge(int u1, int u2, int w) : user1(u1), user2(u2), weight(w) {}
     };
 
-    vector<vector<string>> detectCommunities(int threshold);
+    vector<vector<string>> detectCommunities(int threshold) const;
 
-    // Floyd-Warshall algorithm implementation
+    // Floyd-Warshall algorithm implementation (builds the dense distance matrix on demand).
+    // Rows and columns follow getUsers().
     vector<vector<int>> floydWarshall() const;
 
     // Utility functions
-    const unordered_map<string, vector<string>> &getAdjacencyList() const;
-    const vector<string> &getUsers() const;
-    int getUserCount() const;
+    vector<string> getUsers() const; // Live users in vertex order
+    int getUserCount() const;        // Live users
+    size_t getConnectionCount() const;
 
 private:
     // Helper functions for community detection
     vector<Edge> getAllEdges() const;
-    int find(vector<int> &parent, int i);
-    void unionSets(vector<int> &parent, vector<int> &rank, int x, int y);
+    static int find(vector<int> &parent, int i);
+    static void unionSets(vector<int> &parent, vector<int> &rank, int x, int y);
 };
 
-#endif // GRAPH_HPP
\ No newline at end of file
+#endif // GRAPH_HPP
@@ -0,0 +1,88 @@
+#ifndef GRAPH_METRICS_HPP
+#define GRAPH_METRICS_HPP
+
+#include <vector>
+#include <utility>
+#include "Graph.hpp"
+
+using namespace std;
+
+// Triangle statistics; per-vertex entries are indexed by vertex number and are zero for
+// removed vertices
+struct TriangleCounts
+{
+    unsigned long long total = 0;
+    vector<unsigned long long> perVertex; // Triangles each vertex is part of
+    vector<double> clustering;            // Local clustering coefficient: triangles / (degree choose 2)
+    double averageClustering = 0;         // Mean of clustering over live vertices
+    double transitivity = 0;              // 3 * total / number of connected triples
+};
+
+// Whole-graph analytics over vertex numbers, parallelized on the shared thread pool
+class GraphMetrics
+{
+private:
+    // Sorted adjacency restricted to edges towards higher-ranked vertices, where rank
+    // orders vertices by (degree, vertex number). Every triangle is then found exactly
+    // once, from its lowest-ranked corner, and no list is longer than sqrt(2E).
+    struct OrientedGraph
+    {
+        vector<int> vertexOf;         // Rank -> vertex
+        vector<size_t> offsets;       // Rank -> start of its list in targets
+        vector<int> targets;          // Higher ranks, ascending
+        vector<unsigned int> degrees; // Vertex -> live degree
+    };
+
+    // Live vertices renumbered 0 .. size - 1 with CSR neighbour lists in that numbering
+    struct DenseGraph
+    {
+        vector<int> vertexOf;   // Dense index -> vertex
+        vector<size_t> offsets; // Dense index -> start of its list in targets
+        vector<int> targets;
+
+        size_t size() const { return vertexOf.size(); }
+        size_t degree(size_t i) const { return offsets[i + 1] - offsets[i]; }
+    };
+
+    static OrientedGraph orient(const Graph &graph);
+    static DenseGraph densify(const Graph &graph);
+    static vector<double> toVertexOrder(const Graph &graph, const DenseGraph &dense, const vector<double> &values);
+
+public:
+    // Counts triangles by intersecting the oriented lists of both ends of every edge
+    static TriangleCounts countTriangles(const Graph &graph);
+
+    // PageRank by pull-based power iteration: each vertex sums its neighbours' shares,
+    // so iterations need no atomics. Rank of users without connections is spread evenly.
+    // Stops once the L1 change drops below tolerance; iterations reports how many ran.
+    static vector<double> pageRank(const Graph &graph, double damping = 0.85, double tolerance = 1e-6,
+                                   int maxIterations = 100, int *iterations = nullptr);
+
+    // Brandes betweenness estimated from `samples` random source users (all of them when
+    // samples >= user count), scaled up to the full pair count. Sources run in parallel.
+    static vector<double> betweenness(const Graph &graph, size_t samples, unsigned int seed = 1);
+
+    // Degree / (users - 1) for every vertex
+    static vector<double> degreeCentrality(const Graph &graph);
+
+    // Closeness of one vertex, scaled by the fraction of users it can reach
+    // (Wasserman-Faust), so users in small components do not score 1
+    static double closeness(const Graph &graph, int vertex);
+
+    // Live vertices with the k highest scores, best first
+    static vector<pair<int, double>> topK(const Graph &graph, const vector<double> &scores, size_t k);
+
+    // Core number of every vertex (-1 for removed ones): the largest k such that the
+    // vertex is in a subgraph where everyone has at least k connections. Bucket-based
+    // peeling (Batagelj-Zaversnik) in O(V + E).
+    static vector<int> coreNumbers(const Graph &graph);
+
+    // Same result by level-synchronous peeling: each round removes, in parallel, every
+    // vertex whose remaining degree has dropped to the current k
+    static vector<int> coreNumbersParallel(const Graph &graph);
+
+    // The users with core number >= k and the connections among them, as a new graph
+    static Graph kCore(const Graph &graph, const vector<int> &cores, int k);
+};
+
+#endif // GRAPH_METRICS_HPP
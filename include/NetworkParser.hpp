@@ -3,7 +3,8 @@
 
 #include <string>
 #include <vector>
-#include "User.hpp"
+#include <ostream>
+#include "UserStore.hpp"
 #include "Graph.hpp"
 
 using namespace std;
@@ -11,18 +12,25 @@ using namespace std;
 class NetworkParser
 {
 public:
-    // JSON parsing
-    static bool parseJSONFile(const string &filename, Graph &graph, vector<User *> &users);
-    static bool parseCSVFile(const string &filename, Graph &graph, vector<User *> &users);
+    // Loading replaces graph and users with the file's network; on failure both are left untouched
+    static bool parseJSONFile(const string &filename, Graph &graph, UserStore &users);
+    static bool parseCSVFile(const string &filename, Graph &graph, UserStore &users);
 
     // Data export
-    static bool exportToJSON(const string &filename, const Graph &graph, const vector<User *> &users);
-    static bool exportToCSV(const string &filename, const Graph &graph, const vector<User *> &users);
+    static bool exportToJSON(const string &filename, const Graph &graph, const UserStore &users);
+    static bool exportToCSV(const string &filename, const Graph &graph, const UserStore &users);
+
+    // Progress messages while loading go to cout when verbose (the default, for the menu)
+    // and are dropped otherwise. Errors always go to cerr.
+    static void setVerbose(bool enabled);
 
 private:
+    static bool verbose;
+    static ostream &progress();
+
     // Helper functions for JSON parsing
     static string readFile(const string &filename);
-    static void parseUserData(const string &jsonStr, size_t &pos, User *&user);
+    static User parseUserData(const string &jsonStr, size_t &pos, UserStore &users);
     static void parseConnections(const string &jsonStr, size_t &pos, Graph &graph);
     static string parseString(const string &jsonStr, size_t &pos);
     static int parseNumber(const string &jsonStr, size_t &pos);
@@ -0,0 +1,74 @@
+#ifndef QUERY_ENGINE_HPP
+#define QUERY_ENGINE_HPP
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <unordered_map>
+#include "UserStore.hpp"
+#include "RoaringBitmap.hpp"
+
+using namespace std;
+
+// Conjunctive attribute filter; every field left at its default matches all users
+struct UserQuery
+{
+    int minAge = numeric_limits<int>::min();
+    int maxAge = numeric_limits<int>::max();
+    string location;            // Exact location, empty for any
+    vector<string> interests;   // The user must have all of them (exact values)
+    vector<string> profileKeys; // The user must have profile data for all of them
+};
+
+// Answers UserQuery filters from secondary indexes built over a UserStore: a sorted
+// (age, row) index and a roaring bitmap per location, per interest and per profile key.
+// The planner intersects the bitmaps from the fewest matching rows up, stopping once
+// nothing is left. The age range joins the intersection only when it is the most
+// selective predicate; otherwise the rows that survive are checked against the age column.
+// The index covers the rows present at construction; rebuild it after the store changes.
+class QueryEngine
+{
+private:
+    enum class PredicateType
+    {
+        AGE,
+        LOCATION,
+        INTEREST,
+        PROFILE_KEY
+    };
+
+    struct Predicate
+    {
+        PredicateType type;
+        unsigned int id;    // Location or interest ID, or profile key position
+        size_t estimate;    // Rows matching this predicate alone
+        string description;
+    };
+
+    const UserStore &users;
+    size_t indexedCount;
+
+    vector<pair<int, unsigned int>> ageIndex;       // Sorted by (age, row)
+    vector<RoaringBitmap> locationBitmaps;          // Location ID -> rows
+    vector<RoaringBitmap> interestBitmaps;          // Interest ID -> rows
+    vector<string> profileKeys;
+    vector<RoaringBitmap> profileKeyBitmaps;        // Parallel to profileKeys
+
+    // Predicates of the query ordered most selective first; false when one can never match
+    bool plan(const UserQuery &query, vector<Predicate> &predicates) const;
+    const RoaringBitmap &bitmapOf(const Predicate &predicate) const; // Not for AGE
+    RoaringBitmap ageBitmap(const UserQuery &query) const;
+
+public:
+    // Indexes the users currently in the store, which must outlive the engine
+    explicit QueryEngine(const UserStore &indexedUsers);
+
+    vector<ConstUser> search(const UserQuery &query) const;
+
+    // Human-readable execution plan, one predicate per line in evaluation order
+    string explain(const UserQuery &query) const;
+
+    size_t getIndexedCount() const;
+};
+
+#endif // QUERY_ENGINE_HPP
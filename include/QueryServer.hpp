@@ -0,0 +1,71 @@
+#ifndef QUERY_SERVER_HPP
+#define QUERY_SERVER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "CommandRunner.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+// Long-running query service on a Unix-domain socket. Each request is one line of
+// JSON, e.g. {"command": "recommend", "args": ["user1"]}, answered by one line of JSON
+// from CommandRunner. One thread polls every connection; each complete request line is
+// handed to a dedicated thread pool, so idle clients hold no worker. A client has at
+// most one request running at a time, which keeps its responses in request order.
+// Queries read a snapshot of the network while mutations publish new versions, so
+// clients may update users and connections; commands that touch files are refused.
+class QueryServer
+{
+private:
+    static atomic<bool> stopRequested;
+
+    struct Client
+    {
+        string input;  // Received bytes not yet taken as a request
+        string output; // Responses not yet sent
+        bool busy = false;        // A request is on the pool
+        bool inputClosed = false; // The client sent EOF or an oversized request
+        bool failed = false;      // The connection broke; close once idle
+    };
+
+    CommandRunner &runner;
+    string socketPath;
+    ThreadPool clientPool;
+
+    // Finished responses by client socket, collected by the poll loop. Workers write a
+    // byte to wakePipe so the loop wakes up for them, and signal jobFinished for the
+    // shutdown path, which waits for every job before closing the pipe.
+    mutex completedMutex;
+    condition_variable jobFinished;
+    vector<pair<int, string>> completed;
+    int wakePipe[2] = {-1, -1};
+
+    // Hands the client's next request line, if any, to the pool
+    void dispatch(int clientFd, Client &client);
+
+public:
+    static const size_t MAX_REQUEST_BYTES = 64 * 1024;
+
+    QueryServer(CommandRunner &commandRunner, const string &path, size_t clientThreads);
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    // Accepts clients until requestStop() is called, then finishes the requests already
+    // running. Throws runtime_error when the socket cannot be set up or polling fails.
+    // The socket file is removed on return.
+    void run();
+
+    // Response line for one request line
+    string handleRequest(const string &line) const;
+
+    // Safe to call from a signal handler
+    static void requestStop();
+};
+
+#endif // QUERY_SERVER_HPP
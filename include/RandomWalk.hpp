@@ -0,0 +1,54 @@
+#ifndef RANDOM_WALK_HPP
+#define RANDOM_WALK_HPP
+
+#include <vector>
+#include <utility>
+#include <functional>
+#include "Graph.hpp"
+
+using namespace std;
+
+// Monte Carlo Personalized PageRank. Each walk starts at the query user and at every
+// step either stops, with the restart probability, or moves to a random neighbour. The
+// share of all steps spent on a user converges to their Personalized PageRank with
+// respect to the query user. Unlike a BFS ranking, the cost depends only on the walk
+// budget and not on how many users lie within a few hops.
+//
+// The engine copies the neighbour lists once into CSR arrays, with a Walker alias table
+// over each list, so every step draws a weighted neighbour in O(1). It is immutable
+// after construction and may be queried from several threads at once.
+class RandomWalkEngine
+{
+private:
+    static const size_t MAX_WALK_LENGTH = 100; // Steps after which a walk is cut off
+    static const size_t WALKS_PER_CHUNK = 1024;
+
+    vector<size_t> offsets;    // Vertex -> start of its slice below; removed vertices get none
+    vector<int> targets;       // Live neighbours
+    vector<float> probability; // Alias table: keep slot i with this probability,
+    vector<int> alias;         // else take slot alias[i] of the same slice. Empty when unweighted.
+
+    // Vose's construction over one slice; weights are overwritten
+    static void buildAlias(double *weights, size_t count, float *probability, int *alias);
+
+public:
+    // Walks move to neighbour v of u in proportion to weight(u, v), which must be positive
+    // and safe to call from several threads; uniformly when no weight is given
+    explicit RandomWalkEngine(const Graph &graph, const function<double(int, int)> &weight = nullptr);
+
+    // Estimated Personalized PageRank of every vertex the walks reached, highest first.
+    // Walks run in parallel in fixed chunks, each drawing from its own generator seeded
+    // with (seed, chunk), so the result depends only on the arguments and not on the
+    // thread count.
+    vector<pair<int, double>> personalizedPageRank(int source, size_t walks, double restart = 0.15,
+                                                   unsigned int seed = 1) const;
+
+    // The k highest-scoring vertices that are neither the source nor its neighbours
+    vector<pair<int, double>> recommend(int source, size_t k, size_t walks, double restart = 0.15,
+                                        unsigned int seed = 1) const;
+
+    int getVertexCount() const;
+    size_t getBytesUsed() const;
+};
+
+#endif // RANDOM_WALK_HPP
@@ -0,0 +1,59 @@
+#ifndef RECOMMENDATION_CACHE_HPP
+#define RECOMMENDATION_CACHE_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+using namespace std;
+
+struct RecommendationCacheStats
+{
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long invalidations = 0; // Entries dropped because the graph changed
+    size_t entries = 0;
+};
+
+// Per-vertex top-k recommendation rankings (vertex numbers, best first) kept by Graph.
+// Lookups come from const graphs shared between threads, so every access is locked. A
+// copy takes the entries and counters of the source under its lock and gets a mutex of
+// its own, so a graph copied into a new version keeps its warm cache.
+class RecommendationCache
+{
+private:
+    struct Entry
+    {
+        vector<int> ranking;
+        size_t k; // Requested length; a shorter ranking lists every candidate
+
+        // Whether the first `length` recommendations are all known
+        bool covers(size_t length) const { return k >= length || ranking.size() < k; }
+    };
+
+    mutable mutex cacheMutex;
+    unordered_map<int, Entry> entries;
+    RecommendationCacheStats stats;
+
+public:
+    RecommendationCache() = default;
+    RecommendationCache(const RecommendationCache &other);
+    RecommendationCache &operator=(const RecommendationCache &other);
+
+    // Copies the first k entries of the vertex's ranking into ranking and counts a hit, or
+    // counts a miss and returns false when nothing long enough is cached
+    bool find(int vertex, size_t k, vector<int> &ranking);
+    // Keeps the ranking unless a longer one is already cached
+    void store(int vertex, size_t k, vector<int> ranking);
+
+    void invalidate(const vector<int> &vertices);
+    // Follows Graph::compact: entries move to their new vertex numbers, old number -> new
+    // (-1 for users that are gone)
+    void remap(const vector<int> &newIndex);
+    void clear();
+
+    bool empty() const;
+    RecommendationCacheStats getStats() const;
+};
+
+#endif // RECOMMENDATION_CACHE_HPP
@@ -0,0 +1,49 @@
+#ifndef ROARING_BITMAP_HPP
+#define ROARING_BITMAP_HPP
+
+#include <vector>
+
+using namespace std;
+
+// Compressed set of 32-bit integers (row numbers). Values are grouped by their high
+// 16 bits; each group is a sorted array while small and a 65536-bit bitmap once it
+// holds more than ARRAY_LIMIT values.
+class RoaringBitmap
+{
+private:
+    static const unsigned int ARRAY_LIMIT = 4096;
+    static const unsigned int BITMAP_WORDS = 1024;
+
+    struct Container
+    {
+        unsigned short key;
+        unsigned int cardinality;
+        vector<unsigned short> array;    // Sorted values, when not a bitmap
+        vector<unsigned long long> bits; // BITMAP_WORDS words, when dense
+
+        explicit Container(unsigned short highBits);
+
+        bool isBitmap() const;
+        bool contains(unsigned short low) const;
+        void add(unsigned short low);
+        void appendTo(vector<unsigned int> &values) const;
+        static Container intersect(const Container &a, const Container &b);
+    };
+
+    vector<Container> containers; // Sorted by key
+
+    const Container *findContainer(unsigned short key) const;
+
+public:
+    RoaringBitmap();
+
+    void add(unsigned int value);
+    bool contains(unsigned int value) const;
+    size_t cardinality() const;
+    bool empty() const;
+
+    RoaringBitmap intersect(const RoaringBitmap &other) const;
+    vector<unsigned int> toVector() const; // Ascending
+};
+
+#endif // ROARING_BITMAP_HPP
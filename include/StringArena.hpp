@@ -0,0 +1,71 @@
+#ifndef STRING_ARENA_HPP
+#define STRING_ARENA_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+// Bump allocator for string bytes. Values are copied into large blocks and keep their
+// address until clear() or destruction, which free every block at once.
+class StringArena
+{
+private:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockUsed;
+    size_t blockCapacity;
+    size_t bytesStored;
+
+public:
+    StringArena();
+    StringArena(StringArena &&other) noexcept;
+    StringArena &operator=(StringArena &&other) noexcept;
+
+    // Copies would alias the same bytes; owners copy their values instead
+    StringArena(const StringArena &) = delete;
+    StringArena &operator=(const StringArena &) = delete;
+
+    // Copies value into the arena and returns a view of the stored bytes
+    string_view store(string_view value);
+    void clear();
+
+    size_t getBytesStored() const;
+    size_t getBlockCount() const;
+};
+
+// Column of strings whose bytes live in an arena. Views stay valid until the column is
+// cleared or destroyed; the bytes of overwritten values are reclaimed only by clear().
+class StringColumn
+{
+private:
+    StringArena arena;
+    vector<string_view> values;
+
+public:
+    StringColumn();
+    StringColumn(const StringColumn &other);
+    StringColumn &operator=(const StringColumn &other);
+    StringColumn(StringColumn &&other) = default; // Blocks move with the arena, so views stay valid
+    StringColumn &operator=(StringColumn &&other) = default;
+
+    void push_back(string_view value);
+    void set(size_t row, string_view value);
+    void swapRemove(size_t row); // Moves the last value into row; the removed bytes stay in the arena until clear()
+    void reserve(size_t rows);
+    void clear();
+
+    string_view operator[](size_t row) const { return values[row]; }
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+    vector<string_view>::const_iterator begin() const { return values.begin(); }
+    vector<string_view>::const_iterator end() const { return values.end(); }
+
+    size_t getBytesStored() const;
+};
+
+#endif // STRING_ARENA_HPP
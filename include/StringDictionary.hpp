@@ -0,0 +1,62 @@
+#ifndef STRING_DICTIONARY_HPP
+#define STRING_DICTIONARY_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include "StringArena.hpp"
+
+using namespace std;
+
+// Interning table mapping each distinct string to a small dense ID (0, 1, 2, ...).
+// Columns store IDs instead of strings, so equal values compare in O(1) and each
+// distinct value is stored once, in an arena.
+class StringDictionary
+{
+private:
+    StringArena arena;
+    unordered_map<string_view, unsigned int> ids; // Keys view the arena
+    vector<string_view> values;
+
+public:
+    static const unsigned int NOT_FOUND = ~0u;
+
+    StringDictionary();
+    StringDictionary(const StringDictionary &other);
+    StringDictionary &operator=(const StringDictionary &other);
+    StringDictionary(StringDictionary &&other) = default; // Arena blocks move too, so the views stay valid
+    StringDictionary &operator=(StringDictionary &&other) = default;
+
+    // ID of value, adding it if it is new
+    unsigned int intern(string_view value);
+
+    // ID of value, or NOT_FOUND
+    unsigned int find(string_view value) const;
+
+    string_view lookup(unsigned int id) const;
+    size_t size() const;
+    void clear();
+};
+
+// Set of dictionary IDs as a bitset, e.g. the interests a query is interested in
+class IdBitset
+{
+private:
+    vector<unsigned long long> words;
+
+public:
+    IdBitset();
+    explicit IdBitset(size_t idCount);
+
+    void insert(unsigned int id);
+    bool contains(unsigned int id) const
+    {
+        size_t word = id / 64;
+        return word < words.size() && (words[word] >> (id % 64) & 1);
+    }
+    bool empty() const;
+    size_t count() const;
+};
+
+#endif // STRING_DICTIONARY_HPP
@@ -2,11 +2,30 @@
 #define STRING_SEARCH_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include "User.hpp"
+#include "UserStore.hpp"
+#include "Graph.hpp"
+#include "AhoCorasick.hpp"
 
 using namespace std;
 
+// Substring matching algorithm used by the profile searches
+enum class SearchAlgorithm
+{
+    KMP,
+    RABIN_KARP,
+    SIMD // First/last-byte vector filter (AVX2 or SSE2, chosen at runtime) with a scalar fallback
+};
+
+// User field scanned by the generic (parallel) profile search
+enum class SearchField
+{
+    NAME,
+    LOCATION,
+    INTEREST
+};
+
 class StringSearch
 {
 private:
@@ -22,17 +41,111 @@ private:
     static long long calculatePowerValue(int m);
 
 public:
+    // A search pattern compiled once (case-folded, LPS table and rolling hash precomputed)
+    // and matched against raw text with on-the-fly case folding, without allocating
+    class Pattern
+    {
+    private:
+        string folded;
+        vector<int> lps;
+        long long patternHash;
+        long long highPower; // d^(m-1) % PRIME, weight of the character leaving the window
+
+        // Both return the number of matches; with no positions vector they stop at the first one
+        size_t searchKMP(string_view text, vector<size_t> *positions) const;
+        size_t searchRabinKarp(string_view text, vector<size_t> *positions) const;
+        size_t searchSIMD(string_view text, vector<size_t> *positions) const;
+        size_t search(string_view text, SearchAlgorithm algorithm, vector<size_t> *positions) const;
+
+    public:
+        explicit Pattern(const string &pattern);
+
+        bool empty() const;
+        bool matches(string_view text, SearchAlgorithm algorithm) const;
+        bool matches(string_view text, bool useKMP = true) const;
+        vector<size_t> findAll(string_view text, SearchAlgorithm algorithm) const;
+        vector<size_t> findAll(string_view text, bool useKMP = true) const;
+    };
+
+    // Pattern for approximate matching with Myers' bit-parallel algorithm. distance()
+    // returns the smallest edit distance between the pattern and any substring of text
+    // (case-insensitive); patterns longer than 64 characters fall back to plain DP.
+    class ApproximatePattern
+    {
+    private:
+        string folded;
+        vector<unsigned long long> peq; // Per character: bit i set when folded[i] is that character
+
+        int dynamicProgrammingDistance(string_view text) const;
+
+    public:
+        explicit ApproximatePattern(const string &pattern);
+
+        size_t length() const;
+        int distance(string_view text) const;
+    };
+
     // KMP (Knuth-Morris-Pratt) algorithm implementation
     static vector<size_t> KMPSearch(const string &text, const string &pattern);
 
     // Rabin-Karp algorithm implementation
     static vector<size_t> RabinKarpSearch(const string &text, const string &pattern);
 
+    // Vectorized first/last-byte filtered search
+    static vector<size_t> SIMDSearch(const string &text, const string &pattern);
+
+    // Name of the vector kernel SIMDSearch dispatches to on this CPU ("avx2", "sse2" or "scalar")
+    static const char *getSIMDKernelName();
+
     // Profile search functions
-    static vector<User *> searchUsersByName(const vector<User *> &users, const string &searchPattern, bool useKMP = true);
-    static vector<User *> searchUsersByLocation(const vector<User *> &users, const string &searchPattern, bool useKMP = true);
-    static vector<User *> searchUsersByInterest(const vector<User *> &users, const string &searchPattern, bool useKMP = true);
-    static vector<User *> searchUsersByProfileData(const vector<User *> &users, const string &key, const string &searchPattern, bool useKMP = true);
+    static vector<ConstUser> searchUsersByName(const UserStore &users, const string &searchPattern, bool useKMP = true);
+    static vector<ConstUser> searchUsersByLocation(const UserStore &users, const string &searchPattern, bool useKMP = true);
+    static vector<ConstUser> searchUsersByInterest(const UserStore &users, const string &searchPattern, bool useKMP = true);
+    static vector<ConstUser> searchUsersByProfileData(const UserStore &users, const string &key, const string &searchPattern, bool useKMP = true);
+
+    static vector<ConstUser> searchUsersByName(const UserStore &users, const string &searchPattern, SearchAlgorithm algorithm);
+    static vector<ConstUser> searchUsersByLocation(const UserStore &users, const string &searchPattern, SearchAlgorithm algorithm);
+    static vector<ConstUser> searchUsersByInterest(const UserStore &users, const string &searchPattern, SearchAlgorithm algorithm);
+    static vector<ConstUser> searchUsersByProfileData(const UserStore &users, const string &key, const string &searchPattern, SearchAlgorithm algorithm);
+
+    // Parallel profile search: the user list is split into chunks matched on the shared
+    // thread pool, and results keep the original user order. Lists shorter than
+    // PARALLEL_SEARCH_CUTOFF are searched on the calling thread.
+    static const size_t PARALLEL_SEARCH_CUTOFF = 4096;
+    static vector<ConstUser> parallelSearchUsers(const UserStore &users, SearchField field, const string &searchPattern, SearchAlgorithm algorithm = SearchAlgorithm::KMP);
+
+    // Neighbourhood search: users within maxHops of sourceId whose field matches the
+    // pattern, nearest first. The predicate is evaluated while the bounded BFS expands
+    // and the search stops once limit users are found (0 means no limit).
+    struct NeighbourhoodMatch
+    {
+        ConstUser user;
+        int hops;
+    };
+
+    static vector<NeighbourhoodMatch> searchNeighbourhood(const Graph &graph, const UserStore &users, const string &sourceId, int maxHops, SearchField field, const string &searchPattern, size_t limit = 0, SearchAlgorithm algorithm = SearchAlgorithm::KMP);
+
+    // Approximate (typo-tolerant) name search: users whose name contains the pattern
+    // within maxDistance edits, ranked by distance. This scans every user; see
+    // FuzzyNameIndex for the indexed version.
+    struct FuzzyMatch
+    {
+        ConstUser user;
+        int distance;
+    };
+
+    static int approximateDistance(const string &text, const string &pattern);
+    static vector<FuzzyMatch> fuzzySearchUsersByName(const UserStore &users, const string &searchPattern, int maxDistance);
+
+    // Multi-pattern profile search (Aho-Corasick): each user is scanned once for all patterns
+    struct MultiPatternMatch
+    {
+        ConstUser user;
+        vector<int> patternIds; // Indices into the searched pattern list, ascending
+    };
+
+    static vector<MultiPatternMatch> searchUsersByInterests(const UserStore &users, const vector<string> &searchPatterns);
+    static vector<MultiPatternMatch> searchUsersByKeywords(const UserStore &users, const vector<string> &searchPatterns);
 };
 
 #endif // STRING_SEARCH_HPP
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+// Fixed-size pool of worker threads shared by the parallel algorithms
+class ThreadPool
+{
+private:
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex queueMutex;
+    condition_variable taskAvailable;
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(size_t threadCount = thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t getThreadCount() const;
+
+    // Queues a task to run on some worker
+    void submit(function<void()> task);
+
+    // Runs body(chunkBegin, chunkEnd) over [begin, end) split into chunks of grainSize
+    // and returns once every chunk is done. The calling thread works on chunks too, so
+    // it is safe to call from inside a pool task. The first exception thrown is rethrown.
+    void parallelFor(size_t begin, size_t end, size_t grainSize, const function<void(size_t, size_t)> &body);
+
+    // Process-wide pool with one thread per hardware thread
+    static ThreadPool &shared();
+};
+
+#endif // THREAD_POOL_HPP
@@ -4,29 +4,94 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include "StringDictionary.hpp"
 
 using namespace std;
 
-class User
+class UserStore;
+
+// Read-only view of one user's interests: a run of interest IDs in the store's
+// interest column, dereferenced through the interest dictionary
+class InterestRange
 {
 private:
-    string userId;
-    string name;
-    int age;
-    string location;
-    vector<string> interests;
-    unordered_map<string, string> profileData;
+    const unsigned int *first;
+    const unsigned int *last;
+    const StringDictionary *dictionary;
+
+public:
+    class iterator
+    {
+    private:
+        const unsigned int *id;
+        const StringDictionary *dictionary;
+
+    public:
+        iterator(const unsigned int *position, const StringDictionary *names) : id(position), dictionary(names) {}
+
+        string_view operator*() const { return dictionary->lookup(*id); }
+        iterator &operator++()
+        {
+            ++id;
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return id == other.id; }
+        bool operator!=(const iterator &other) const { return id != other.id; }
+    };
+
+    InterestRange(const unsigned int *begin, const unsigned int *end, const StringDictionary *names)
+        : first(begin), last(end), dictionary(names) {}
+
+    iterator begin() const { return iterator(first, dictionary); }
+    iterator end() const { return iterator(last, dictionary); }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    string_view operator[](size_t i) const { return dictionary->lookup(first[i]); }
+
+    // Interest IDs, for comparisons without touching the strings
+    const unsigned int *idsBegin() const { return first; }
+    const unsigned int *idsEnd() const { return last; }
+};
+
+// Read-only handle to one row of a UserStore, as handed out by a const store. Copies
+// are cheap and stay valid while the store keeps the row (rows are appended; removeUser
+// renumbers the last row and clear() drops them all).
+class ConstUser
+{
+protected:
+    const UserStore *store;
+    size_t row;
 
 public:
-    User(const string &id, const string &userName, int userAge = 0,
-         const string &userLocation = "");
+    ConstUser(const UserStore *userStore, size_t userRow);
 
-    // Getters
-    string getUserId() const;
-    string getName() const;
+    size_t getRow() const;
+
+    // Getters (views stay valid while the store keeps the row)
+    string_view getUserId() const;
+    string_view getName() const;
     int getAge() const;
-    string getLocation() const;
-    vector<string> getInterests() const;
+    string_view getLocation() const;
+    InterestRange getInterests() const;
+
+    const string &getProfileData(const string &key) const; // Empty string when the key is absent
+    bool hasProfileData(const string &key) const;
+
+    // String representation
+    string toString() const;
+
+    bool operator==(const ConstUser &other) const;
+    bool operator!=(const ConstUser &other) const;
+};
+
+// Row handle with write access, only available from a non-const store
+class User : public ConstUser
+{
+private:
+    UserStore *writableStore;
+
+public:
+    User(UserStore *userStore, size_t userRow);
 
     // Setters
     void setName(const string &newName);
@@ -37,11 +102,6 @@ public:
 
     // Profile data management
     void addProfileData(const string &key, const string &value);
-    string getProfileData(const string &key) const;
-    bool hasProfileData(const string &key) const;
-
-    // String representation
-    string toString() const;
 };
 
-#endif // USER_HPP
\ No newline at end of file
+#endif // USER_HPP
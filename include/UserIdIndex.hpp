@@ -0,0 +1,49 @@
+#ifndef USER_ID_INDEX_HPP
+#define USER_ID_INDEX_HPP
+
+#include <string_view>
+#include <vector>
+#include "StringArena.hpp"
+
+using namespace std;
+
+// Flat open-addressing hash table from user ID to row. Slots hold only the row and
+// the ID's hash; the ID itself is read from the store's ID column when a probe hits a
+// matching hash, so the table copies as plain integers. Linear probing, kept at most
+// half full.
+class UserIdIndex
+{
+private:
+    static const unsigned int EMPTY = ~0u;
+
+    struct Slot
+    {
+        unsigned int row;
+        unsigned int hash;
+    };
+
+    vector<Slot> slots; // Size is zero or a power of two
+    size_t count;
+
+    static unsigned int hashId(string_view id);
+    void grow();
+
+public:
+    static const size_t NOT_FOUND = ~(size_t)0;
+
+    UserIdIndex();
+
+    // Adds row under ids[row] unless that ID is already indexed; returns whether it was added
+    bool insert(unsigned int row, const StringColumn &ids);
+    size_t find(string_view id, const StringColumn &ids) const;
+    // Both look ids[row] up, so call them before the column changes. Rows that are not
+    // indexed (later duplicates of an ID) are ignored.
+    void erase(unsigned int row, const StringColumn &ids);
+    void relabel(unsigned int row, unsigned int newRow, const StringColumn &ids);
+
+    void reserve(size_t rows);
+    void clear();
+    size_t size() const;
+};
+
+#endif // USER_ID_INDEX_HPP
@@ -0,0 +1,121 @@
+#ifndef USER_STORE_HPP
+#define USER_STORE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include "User.hpp"
+#include "StringArena.hpp"
+#include "UserIdIndex.hpp"
+
+using namespace std;
+
+// Column-oriented storage for all users. Each attribute lives in its own contiguous
+// array indexed by row, so filters over one attribute are linear scans. IDs and names
+// are arena-backed string columns, so loading costs a few large allocations. Locations and
+// interests are interned: the columns hold dictionary IDs. Interests are one shared
+// column; row r owns interestIds[interestStart[r] .. + interestCount[r]). Blocks left
+// behind by growing, shrinking or removed rows are reclaimed by compacting the column
+// once they outnumber the live entries.
+// Profile data is sparse: one row -> value map per key.
+class UserStore
+{
+private:
+    StringColumn ids;
+    StringColumn names;
+    vector<int> ages;
+    vector<unsigned int> locationIds;
+    StringDictionary locationDictionary;
+
+    vector<unsigned int> interestStart;
+    vector<unsigned int> interestCount;
+    vector<unsigned int> interestIds;
+    StringDictionary interestDictionary;
+    size_t deadInterestSlots; // Entries of interestIds no row refers to any more
+
+    unordered_map<string, unordered_map<unsigned int, string>> profileColumns;
+    UserIdIndex idIndex; // First row added with each ID
+
+    // Makes row's interests the last block of the column so it can grow in place
+    void moveInterestsToEnd(size_t row);
+    // Marks count slots at start unused; the column is compacted once most slots are
+    void releaseInterests(size_t start, size_t count);
+    // Rewrites the interest column with the blocks in row order, lastRow's block at the
+    // end when given, dropping every unused slot
+    void compactInterests(size_t lastRow = NOT_FOUND);
+
+public:
+    class iterator
+    {
+    private:
+        const UserStore *store;
+        size_t row;
+
+    public:
+        iterator(const UserStore *userStore, size_t userRow) : store(userStore), row(userRow) {}
+
+        ConstUser operator*() const { return ConstUser(store, row); }
+        iterator &operator++()
+        {
+            ++row;
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return row == other.row; }
+        bool operator!=(const iterator &other) const { return row != other.row; }
+    };
+
+    static const size_t NOT_FOUND = UserIdIndex::NOT_FOUND;
+
+    UserStore();
+
+    // Appends a user and returns its view
+    User addUser(string_view id, string_view name, int age = 0, string_view location = "");
+    // Deletes the row by moving the last row into its place, so that row changes number.
+    // Returns false when no user has this ID.
+    bool removeUser(string_view id);
+    void reserve(size_t rows);
+    void clear();
+
+    size_t size() const;
+    bool empty() const;
+
+    User operator[](size_t row);
+    ConstUser operator[](size_t row) const;
+
+    // Rows in order, read-only; index with operator[] to modify them
+    iterator begin() const;
+    iterator end() const;
+
+    // Row of the user with this ID in O(1), NOT_FOUND when absent. Every front end
+    // resolves IDs through this rather than scanning the ID column.
+    size_t findRow(string_view id) const;
+    bool contains(string_view id) const;
+
+    // Whole columns, for scans
+    const StringColumn &getIds() const;
+    const StringColumn &getNames() const;
+    const vector<int> &getAges() const;
+    const vector<unsigned int> &getLocationIds() const;
+    const StringDictionary &getLocationDictionary() const;
+    const StringDictionary &getInterestDictionary() const;
+
+    // Row accessors behind the User view
+    string_view getLocation(size_t row) const;
+    InterestRange getInterests(size_t row) const;
+    bool hasInterest(size_t row, unsigned int interestId) const;
+    bool hasAnyInterest(size_t row, const IdBitset &interests) const;
+    void setName(size_t row, const string &name);
+    void setAge(size_t row, int age);
+    void setLocation(size_t row, const string &location);
+    void addInterest(size_t row, const string &interest);
+    void removeInterest(size_t row, const string &interest);
+
+    void setProfileData(size_t row, const string &key, const string &value);
+    const string *findProfileData(size_t row, const string &key) const; // nullptr when absent
+    vector<pair<string, string>> getProfileData(size_t row) const;
+    vector<string> getProfileKeys() const;
+    const unordered_map<unsigned int, string> *findProfileColumn(const string &key) const; // Row -> value, nullptr when unused
+};
+
+#endif // USER_STORE_HPP
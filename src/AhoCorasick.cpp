@@ -0,0 +1,137 @@
+#include "../include/AhoCorasick.hpp"
+#include <cctype>
+#include <queue>
+
+using namespace std;
+
+AhoCorasick::AhoCorasick(const vector<string> &patterns)
+    : byteClass(256, 0), numClasses(1)
+{
+    build(patterns);
+}
+
+void AhoCorasick::build(const vector<string> &patterns)
+{
+    // Assign an alphabet class to every (case-folded) byte used by a pattern
+    for (const string &pattern : patterns)
+    {
+        for (char ch : pattern)
+        {
+            unsigned char lower = tolower((unsigned char)ch);
+            if (byteClass[lower] == 0)
+            {
+                byteClass[lower] = numClasses;
+                byteClass[toupper(lower)] = numClasses;
+                numClasses++;
+            }
+        }
+    }
+
+    // Build the trie directly in the flat table (-1 = no edge yet)
+    transitions.assign(numClasses, -1);
+    vector<vector<int>> stateOutputs(1);
+
+    for (size_t id = 0; id < patterns.size(); id++)
+    {
+        patternLengths.push_back(patterns[id].length());
+        if (patterns[id].empty())
+            continue; // An empty pattern never matches, as in KMPSearch
+
+        int state = 0;
+        for (char ch : patterns[id])
+        {
+            int &next = transitions[state * numClasses + byteClass[(unsigned char)ch]];
+            if (next == -1)
+            {
+                next = stateOutputs.size();
+                stateOutputs.emplace_back();
+                transitions.resize(transitions.size() + numClasses, -1);
+            }
+            state = transitions[state * numClasses + byteClass[(unsigned char)ch]];
+        }
+        stateOutputs[state].push_back(id);
+    }
+
+    // Complete the automaton breadth-first using failure links
+    int stateCount = stateOutputs.size();
+    vector<int> fail(stateCount, 0);
+    queue<int> pending;
+
+    for (int c = 0; c < numClasses; c++)
+    {
+        int &next = transitions[c];
+        if (next == -1)
+        {
+            next = 0;
+        }
+        else
+        {
+            fail[next] = 0;
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        int state = pending.front();
+        pending.pop();
+
+        // Inherit the outputs of the longest proper suffix that is also a trie node
+        const vector<int> &inherited = stateOutputs[fail[state]];
+        stateOutputs[state].insert(stateOutputs[state].end(), inherited.begin(), inherited.end());
+
+        for (int c = 0; c < numClasses; c++)
+        {
+            int &next = transitions[state * numClasses + c];
+            int fallback = transitions[fail[state] * numClasses + c];
+            if (next == -1)
+            {
+                next = fallback;
+            }
+            else
+            {
+                fail[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+
+    // Flatten the per-state output lists
+    outputOffsets.assign(stateCount + 1, 0);
+    for (int s = 0; s < stateCount; s++)
+    {
+        outputOffsets[s + 1] = outputOffsets[s] + stateOutputs[s].size();
+        outputs.insert(outputs.end(), stateOutputs[s].begin(), stateOutputs[s].end());
+    }
+}
+
+size_t AhoCorasick::getPatternCount() const
+{
+    return patternLengths.size();
+}
+
+size_t AhoCorasick::getStateCount() const
+{
+    return outputOffsets.size() - 1;
+}
+
+vector<pair<size_t, int>> AhoCorasick::search(string_view text) const
+{
+    vector<pair<size_t, int>> matches;
+    scan(text, [&matches](int id, size_t position)
+         { matches.push_back({position, id}); });
+    return matches;
+}
+
+size_t AhoCorasick::markMatches(string_view text, vector<char> &matched) const
+{
+    size_t newlyMatched = 0;
+    scan(text, [&matched, &newlyMatched](int id, size_t)
+         {
+             if (!matched[id])
+             {
+                 matched[id] = 1;
+                 newlyMatched++;
+             } });
+    return newlyMatched;
+}
@@ -0,0 +1,122 @@
+#include "../include/AutocompleteIndex.hpp"
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+using namespace std;
+
+static string toLowerName(string_view name)
+{
+    string lower(name);
+    for (char &c : lower)
+    {
+        c = tolower((unsigned char)c);
+    }
+    return lower;
+}
+
+AutocompleteIndex::AutocompleteIndex(const UserStore &indexedUsers, const Graph &graph) : users(indexedUsers)
+{
+    // Deduplicate lower-cased names and group users by name
+    unordered_map<string, unsigned int> nameIds;
+    vector<vector<unsigned int>> usersByName;
+    const StringColumn &names = users.getNames();
+
+    for (size_t row = 0; row < names.size(); row++)
+    {
+        string lower = toLowerName(names[row]);
+        auto inserted = nameIds.emplace(lower, usersByName.size());
+        if (inserted.second)
+        {
+            unsigned int offset = nameBytes.size();
+            nameBytes += lower;
+            usersByName.emplace_back();
+
+            // One key per word start
+            for (size_t j = 0; j < lower.length(); j++)
+            {
+                if (!isspace((unsigned char)lower[j]) && (j == 0 || isspace((unsigned char)lower[j - 1])))
+                {
+                    keys.push_back({offset + (unsigned int)j, (unsigned int)(lower.length() - j), inserted.first->second});
+                }
+            }
+        }
+        usersByName[inserted.first->second].push_back(row);
+    }
+
+    nameUserOffsets.push_back(0);
+    for (const auto &group : usersByName)
+    {
+        nameRows.insert(nameRows.end(), group.begin(), group.end());
+        nameUserOffsets.push_back(nameRows.size());
+    }
+    const StringColumn &ids = users.getIds();
+    nameVertices.reserve(nameRows.size());
+    for (unsigned int row : nameRows)
+    {
+        nameVertices.push_back(graph.getUserIndex(string(ids[row])));
+    }
+
+    sort(keys.begin(), keys.end(), [this](const Key &a, const Key &b)
+         { return keyLess(a, b); });
+}
+
+bool AutocompleteIndex::keyLess(const Key &a, const Key &b) const
+{
+    return nameBytes.compare(a.offset, a.length, nameBytes, b.offset, b.length) < 0;
+}
+
+vector<ConstUser> AutocompleteIndex::complete(const string &prefix, size_t limit, const Graph &graph) const
+{
+    string lowerPrefix = toLowerName(prefix);
+
+    // Keys starting with the prefix form one contiguous run of the sorted array
+    auto first = lower_bound(keys.begin(), keys.end(), lowerPrefix, [this](const Key &key, const string &value)
+                             { return nameBytes.compare(key.offset, key.length, value) < 0; });
+
+    vector<unsigned int> matchedNames;
+    for (auto it = first; it != keys.end(); ++it)
+    {
+        if (it->length < lowerPrefix.length() || nameBytes.compare(it->offset, lowerPrefix.length(), lowerPrefix) != 0)
+            break;
+        matchedNames.push_back(it->name);
+    }
+
+    // A name can match through several of its words
+    sort(matchedNames.begin(), matchedNames.end());
+    matchedNames.erase(unique(matchedNames.begin(), matchedNames.end()), matchedNames.end());
+
+    vector<pair<int, unsigned int>> ranked; // (degree, row)
+    for (unsigned int name : matchedNames)
+    {
+        for (unsigned int i = nameUserOffsets[name]; i < nameUserOffsets[name + 1]; i++)
+        {
+            int vertex = nameVertices[i];
+            ranked.push_back({vertex < 0 ? 0 : graph.getDegree(vertex), nameRows[i]});
+        }
+    }
+
+    auto byRank = [this](const pair<int, unsigned int> &a, const pair<int, unsigned int> &b)
+    {
+        if (a.first != b.first)
+            return a.first > b.first;
+        string_view nameA = users.getNames()[a.second];
+        string_view nameB = users.getNames()[b.second];
+        return nameA != nameB ? nameA < nameB : a.second < b.second;
+    };
+
+    size_t count = min(limit, ranked.size());
+    partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), byRank);
+
+    vector<ConstUser> results;
+    for (size_t i = 0; i < count; i++)
+    {
+        results.push_back(users[ranked[i].second]);
+    }
+    return results;
+}
+
+size_t AutocompleteIndex::getDistinctNameBytes() const
+{
+    return nameBytes.size();
+}
@@ -0,0 +1,897 @@
+#include "../include/CommandRunner.hpp"
+#include "../include/GraphMetrics.hpp"
+#include "../include/NetworkParser.hpp"
+#include "../include/StringSearch.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+static void writeJsonString(ostream &out, string_view value)
+{
+    static const char HEX[] = "0123456789abcdef";
+    out << '"';
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\r':
+            out << "\\r";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                out << "\\u00" << HEX[(unsigned char)c >> 4] << HEX[c & 15];
+            else
+                out << c;
+        }
+    }
+    out << '"';
+}
+
+static void writeUser(ostream &out, const ConstUser &user)
+{
+    out << "{\"id\":";
+    writeJsonString(out, user.getUserId());
+    out << ",\"name\":";
+    writeJsonString(out, user.getName());
+    out << ",\"age\":" << user.getAge() << ",\"location\":";
+    writeJsonString(out, user.getLocation());
+    out << ",\"interests\":[";
+    bool first = true;
+    for (string_view interest : user.getInterests())
+    {
+        if (!first)
+            out << ',';
+        writeJsonString(out, interest);
+        first = false;
+    }
+    out << "]}";
+}
+
+string CommandRunner::errorResult(string_view command, string_view message)
+{
+    stringstream ss;
+    ss << "{\"command\":";
+    writeJsonString(ss, command);
+    ss << ",\"error\":";
+    writeJsonString(ss, message);
+    ss << '}';
+    return ss.str();
+}
+
+// Starts a successful result; the caller appends its fields and the closing brace
+static void beginResult(ostream &out, string_view command)
+{
+    out << "{\"command\":";
+    writeJsonString(out, command);
+}
+
+// Level-synchronous peeling only beats the linear bucket algorithm with threads to share it
+static vector<int> coreNumbers(const Graph &graph)
+{
+    return ThreadPool::shared().getThreadCount() > 1 ? GraphMetrics::coreNumbersParallel(graph)
+                                                     : GraphMetrics::coreNumbers(graph);
+}
+
+static VertexOrder parseVertexOrder(const string &name)
+{
+    if (name == "bfs")
+        return VertexOrder::BFS;
+    if (name == "degree")
+        return VertexOrder::DEGREE;
+    if (name == "rcm")
+        return VertexOrder::REVERSE_CUTHILL_MCKEE;
+    throw runtime_error("unknown vertex order " + name + " (expected bfs, degree or rcm)");
+}
+
+// Full BFS over vertex numbers; returns the summed distances so the work cannot be skipped
+static size_t traverseFrom(const Graph &graph, int source, vector<int> &distance)
+{
+    distance.assign(graph.getVertexCount(), -1);
+    queue<int> pending;
+    distance[source] = 0;
+    pending.push(source);
+
+    size_t total = 0;
+    while (!pending.empty())
+    {
+        int current = pending.front();
+        pending.pop();
+        total += distance[current];
+
+        for (int neighbor : graph.getNeighbors(current))
+        {
+            if (distance[neighbor] < 0 && !graph.isRemoved(neighbor))
+            {
+                distance[neighbor] = distance[current] + 1;
+                pending.push(neighbor);
+            }
+        }
+    }
+    return total;
+}
+
+CommandRunner::CommandRunner(VersionedNetwork &versionedNetwork) : network(versionedNetwork) {}
+
+vector<string> CommandRunner::splitWords(const string &line)
+{
+    vector<string> words;
+    stringstream ss(line);
+    string word;
+    while (ss >> word)
+    {
+        words.push_back(word);
+    }
+    return words;
+}
+
+string CommandRunner::run(const vector<string> &words, bool *succeeded)
+{
+    if (succeeded)
+        *succeeded = false;
+    if (words.empty())
+        return errorResult("", "empty command");
+
+    const string &command = words[0];
+    try
+    {
+        // Held for the whole command, so it sees one consistent version
+        shared_ptr<const NetworkSnapshot> snapshot = network.snapshot();
+
+        string result;
+        if (command == "load")
+            result = load(words);
+        else if (command == "export")
+            result = exportNetwork(words, *snapshot);
+        else if (command == "recommend")
+            result = recommend(words, *snapshot);
+        else if (command == "communities")
+            result = communities(words, *snapshot);
+        else if (command == "distance")
+            result = distance(words, *snapshot);
+        else if (command == "search")
+            result = search(words, *snapshot);
+        else if (command == "fuzzy")
+            result = fuzzySearch(words, snapshot);
+        else if (command == "triangles")
+            result = triangles(words, *snapshot);
+        else if (command == "pagerank" || command == "betweenness" || command == "centrality")
+            result = centrality(words, *snapshot);
+        else if (command == "coreness")
+            result = coreness(words, *snapshot);
+        else if (command == "ego")
+            result = ego(words, *snapshot);
+        else if (command == "ppr")
+            result = personalizedPageRank(words, snapshot);
+        else if (command == "cache-stats" || command == "cache-warm")
+            result = recommendationCache(words, *snapshot);
+        else if (command == "benchmark")
+            result = benchmark(words, *snapshot);
+        else if (isMutation(command))
+            result = mutate(words);
+        else
+            return errorResult(command, "unknown command");
+
+        if (succeeded)
+            *succeeded = true;
+        return result;
+    }
+    catch (const exception &e)
+    {
+        return errorResult(command, e.what());
+    }
+}
+
+bool CommandRunner::isReadOnly(const string &command)
+{
+    return command == "recommend" || command == "communities" || command == "distance" || command == "search" || command == "fuzzy" ||
+           command == "triangles" || command == "pagerank" || command == "betweenness" || command == "centrality" ||
+           command == "coreness" || command == "ego" || command == "ppr" ||
+           command == "cache-stats" || command == "cache-warm";
+}
+
+bool CommandRunner::isMutation(const string &command)
+{
+    return command == "add-user" || command == "connect" || command == "disconnect" ||
+           command == "remove-user" || command == "batch" || command == "compact" || command == "reorder" ||
+           command == "compress";
+}
+
+size_t CommandRunner::runScript(istream &in, ostream &out)
+{
+    size_t failures = 0;
+    string line;
+    while (getline(in, line))
+    {
+        vector<string> words = splitWords(line);
+        if (words.empty() || words[0][0] == '#')
+            continue;
+
+        bool succeeded;
+        string result = run(words, &succeeded);
+        if (!succeeded)
+            failures++;
+        out << result << '\n'
+            << flush;
+    }
+    return failures;
+}
+
+string CommandRunner::load(const vector<string> &words)
+{
+    if (words.size() != 2)
+        throw runtime_error("usage: load <file>");
+
+    const string &filename = words[1];
+    Graph graph;
+    UserStore users;
+    bool csv = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+    bool loaded = csv ? NetworkParser::parseCSVFile(filename, graph, users)
+                      : NetworkParser::parseJSONFile(filename, graph, users);
+    if (!loaded)
+        throw runtime_error("could not load " + filename);
+
+    size_t connections = graph.getConnectionCount();
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"file\":";
+    writeJsonString(ss, filename);
+    ss << ",\"users\":" << users.size() << ",\"connections\":" << connections;
+
+    unsigned long long version = network.replace(move(graph), move(users));
+    ss << ",\"version\":" << version << '}';
+    return ss.str();
+}
+
+string CommandRunner::exportNetwork(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    const UserStore &users = *snapshot.users;
+    if (words.size() != 2)
+        throw runtime_error("usage: export <file>");
+
+    const string &filename = words[1];
+    bool csv = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+    bool exported = csv ? NetworkParser::exportToCSV(filename, graph, users)
+                        : NetworkParser::exportToJSON(filename, graph, users);
+    if (!exported)
+        throw runtime_error("could not write " + filename);
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"file\":";
+    writeJsonString(ss, filename);
+    ss << ",\"users\":" << users.size() << '}';
+    return ss.str();
+}
+
+string CommandRunner::recommend(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    const UserStore &users = *snapshot.users;
+    if (words.size() < 2 || words.size() > 3)
+        throw runtime_error("usage: recommend <id> [k]");
+    if (!users.contains(words[1]) || !graph.hasUser(words[1]))
+        throw runtime_error("unknown user " + words[1]);
+    size_t k = words.size() == 3 ? stoul(words[2]) : 10;
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"id\":";
+    writeJsonString(ss, words[1]);
+    ss << ",\"results\":[";
+    bool first = true;
+    for (const string &recommendedId : graph.getTopRecommendations(words[1], k))
+    {
+        size_t row = users.findRow(recommendedId);
+        if (row == UserStore::NOT_FOUND)
+            continue;
+        if (!first)
+            ss << ',';
+        writeUser(ss, users[row]);
+        first = false;
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+// Writes ["id",..] for a list of user IDs
+static void writeIds(ostream &out, const vector<string> &ids)
+{
+    out << '[';
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (i > 0)
+            out << ',';
+        writeJsonString(out, ids[i]);
+    }
+    out << ']';
+}
+
+// Writes [["id",..],..] for groups of user IDs
+static void writeGroups(ostream &out, const vector<vector<string>> &groups)
+{
+    out << '[';
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        if (i > 0)
+            out << ',';
+        writeIds(out, groups[i]);
+    }
+    out << ']';
+}
+
+string CommandRunner::communities(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    if (words.size() > 2)
+        throw runtime_error("usage: communities [k]");
+
+    vector<vector<string>> found;
+    stringstream ss;
+    beginResult(ss, words[0]);
+    if (words.size() == 2)
+    {
+        int k = stoi(words[1]);
+        if (k < 0)
+            throw runtime_error("k must not be negative");
+        Graph core = GraphMetrics::kCore(graph, coreNumbers(graph), k);
+        found = core.detectCommunities(1);
+        ss << ",\"k\":" << k << ",\"users\":" << core.getUserCount() << ",\"connections\":" << core.getConnectionCount();
+    }
+    else
+    {
+        found = graph.detectCommunities(1);
+    }
+
+    ss << ",\"communities\":";
+    writeGroups(ss, found);
+    ss << '}';
+    return ss.str();
+}
+
+string CommandRunner::ego(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    if (words.size() < 2 || words.size() > 3)
+        throw runtime_error("usage: ego <id> [hops]");
+    if (!graph.hasUser(words[1]))
+        throw runtime_error("unknown user " + words[1]);
+    int hops = words.size() == 3 ? stoi(words[2]) : 1;
+    if (hops < 0)
+        throw runtime_error("hops must not be negative");
+
+    Graph egoGraph = graph.egoNetwork(words[1], hops);
+    size_t connections = egoGraph.getConnectionCount();
+    vector<string> members = egoGraph.getUsers();
+
+    // Without the user at the centre, the components are their separate circles of friends
+    egoGraph.removeUser(words[1]);
+    vector<vector<string>> circles = egoGraph.detectCommunities(1);
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"id\":";
+    writeJsonString(ss, words[1]);
+    ss << ",\"hops\":" << hops << ",\"users\":" << members.size() << ",\"connections\":" << connections
+       << ",\"members\":";
+    writeIds(ss, members);
+    ss << ",\"circles\":";
+    writeGroups(ss, circles);
+    ss << '}';
+    return ss.str();
+}
+
+string CommandRunner::distance(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    if (words.size() != 3)
+        throw runtime_error("usage: distance <from-id> <to-id>");
+    for (size_t i = 1; i < 3; i++)
+    {
+        if (!graph.hasUser(words[i]))
+            throw runtime_error("unknown user " + words[i]);
+    }
+
+    int hops = graph.getDistance(words[1], words[2]);
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"from\":";
+    writeJsonString(ss, words[1]);
+    ss << ",\"to\":";
+    writeJsonString(ss, words[2]);
+    ss << ",\"hops\":";
+    if (hops < 0)
+        ss << "null";
+    else
+        ss << hops;
+    ss << '}';
+    return ss.str();
+}
+
+string CommandRunner::triangles(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    if (words.size() > 2)
+        throw runtime_error("usage: triangles [id]");
+    int vertex = -1;
+    if (words.size() == 2)
+    {
+        vertex = graph.getUserIndex(words[1]);
+        if (vertex < 0)
+            throw runtime_error("unknown user " + words[1]);
+    }
+
+    TriangleCounts counts = GraphMetrics::countTriangles(graph);
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"total\":" << counts.total << ",\"average_clustering\":" << counts.averageClustering
+       << ",\"transitivity\":" << counts.transitivity;
+    if (vertex >= 0)
+    {
+        ss << ",\"id\":";
+        writeJsonString(ss, words[1]);
+        ss << ",\"user_triangles\":" << counts.perVertex[vertex] << ",\"clustering\":" << counts.clustering[vertex];
+    }
+    ss << '}';
+    return ss.str();
+}
+
+// Writes ,"results":[{"id":..,"score":..},..] for a ranking from GraphMetrics::topK
+static void writeRanking(ostream &out, const Graph &graph, const vector<pair<int, double>> &ranking)
+{
+    out << ",\"results\":[";
+    for (size_t i = 0; i < ranking.size(); i++)
+    {
+        if (i > 0)
+            out << ',';
+        out << "{\"id\":";
+        writeJsonString(out, graph.getUserId(ranking[i].first));
+        out << ",\"score\":" << ranking[i].second << '}';
+    }
+    out << ']';
+}
+
+string CommandRunner::centrality(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    const string &command = words[0];
+    stringstream ss;
+    beginResult(ss, command);
+
+    if (command == "centrality")
+    {
+        if (words.size() != 2)
+            throw runtime_error("usage: centrality <id>");
+        int vertex = graph.getUserIndex(words[1]);
+        if (vertex < 0)
+            throw runtime_error("unknown user " + words[1]);
+
+        ss << ",\"id\":";
+        writeJsonString(ss, words[1]);
+        ss << ",\"degree\":" << GraphMetrics::degreeCentrality(graph)[vertex]
+           << ",\"closeness\":" << GraphMetrics::closeness(graph, vertex) << '}';
+        return ss.str();
+    }
+
+    size_t k = words.size() > 1 ? stoul(words[1]) : 10;
+    if (command == "pagerank")
+    {
+        if (words.size() > 2)
+            throw runtime_error("usage: pagerank [k]");
+        int iterations;
+        vector<double> ranks = GraphMetrics::pageRank(graph, 0.85, 1e-6, 100, &iterations);
+        ss << ",\"iterations\":" << iterations;
+        writeRanking(ss, graph, GraphMetrics::topK(graph, ranks, k));
+    }
+    else
+    {
+        if (words.size() > 3)
+            throw runtime_error("usage: betweenness [k] [samples]");
+        size_t samples = words.size() > 2 ? stoul(words[2]) : 64;
+        ss << ",\"samples\":" << min<size_t>(samples, graph.getUserCount());
+        writeRanking(ss, graph, GraphMetrics::topK(graph, GraphMetrics::betweenness(graph, samples), k));
+    }
+    ss << '}';
+    return ss.str();
+}
+
+string CommandRunner::coreness(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    if (words.size() > 2)
+        throw runtime_error("usage: coreness [id]");
+    int vertex = -1;
+    if (words.size() == 2)
+    {
+        vertex = graph.getUserIndex(words[1]);
+        if (vertex < 0)
+            throw runtime_error("unknown user " + words[1]);
+    }
+
+    vector<int> cores = coreNumbers(graph);
+    int maxCore = 0;
+    for (int core : cores)
+    {
+        maxCore = max(maxCore, core);
+    }
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"max_core\":" << maxCore;
+    if (vertex >= 0)
+    {
+        ss << ",\"id\":";
+        writeJsonString(ss, words[1]);
+        ss << ",\"core\":" << cores[vertex];
+    }
+    ss << '}';
+    return ss.str();
+}
+
+// Walks follow friends who share more interests more often
+static shared_ptr<const RandomWalkEngine> buildWalkEngine(const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    const UserStore &users = *snapshot.users;
+    vector<size_t> rowOf(graph.getVertexCount(), (size_t)UserStore::NOT_FOUND);
+    for (int vertex = 0; vertex < graph.getVertexCount(); vertex++)
+    {
+        if (!graph.isRemoved(vertex))
+            rowOf[vertex] = users.findRow(graph.getUserId(vertex));
+    }
+    auto weight = [&](int vertex, int neighbor)
+    {
+        if (rowOf[vertex] == UserStore::NOT_FOUND || rowOf[neighbor] == UserStore::NOT_FOUND)
+            return 1.0;
+        InterestRange interests = users.getInterests(rowOf[vertex]);
+        InterestRange others = users.getInterests(rowOf[neighbor]);
+        int shared = 0;
+        for (const unsigned int *id = interests.idsBegin(); id != interests.idsEnd(); ++id)
+        {
+            shared += find(others.idsBegin(), others.idsEnd(), *id) != others.idsEnd();
+        }
+        return 1.0 + shared;
+    };
+
+    return make_shared<const RandomWalkEngine>(graph, weight);
+}
+
+string CommandRunner::personalizedPageRank(const vector<string> &words, const shared_ptr<const NetworkSnapshot> &snapshot)
+{
+    if (words.size() < 2 || words.size() > 4)
+        throw runtime_error("usage: ppr <id> [k] [walks]");
+    if (snapshot->graph.getUserIndex(words[1]) < 0)
+        throw runtime_error("unknown user " + words[1]);
+    size_t k = words.size() > 2 ? stoul(words[2]) : 10;
+    size_t walks = words.size() > 3 ? stoul(words[3]) : 10000;
+    // A query's cost follows its walk budget, so the budget is bounded
+    if (k > MAX_PPR_RESULTS || walks > MAX_PPR_WALKS)
+        throw runtime_error("ppr allows at most " + to_string(MAX_PPR_RESULTS) + " results and " +
+                            to_string(MAX_PPR_WALKS) + " walks");
+
+    // While the engine of a new version is being built, the previous one keeps serving,
+    // so vertex numbers are taken from the version the engine belongs to
+    auto entry = walkEngines.get(snapshot, buildWalkEngine);
+    int vertex = entry.snapshot->graph.getUserIndex(words[1]);
+    if (vertex < 0)
+    {
+        // The user is newer than the engine being served: wait for, or make, an engine of
+        // this version, which then serves everyone
+        entry = walkEngines.getAtLeast(snapshot, buildWalkEngine);
+        vertex = entry.snapshot->graph.getUserIndex(words[1]);
+        if (vertex < 0)
+            throw runtime_error("unknown user " + words[1]);
+    }
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"id\":";
+    writeJsonString(ss, words[1]);
+    ss << ",\"walks\":" << walks;
+    writeRanking(ss, entry.snapshot->graph, entry.value->recommend(vertex, k, walks));
+    ss << '}';
+    return ss.str();
+}
+
+string CommandRunner::recommendationCache(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const Graph &graph = snapshot.graph;
+    const string &command = words[0];
+    if (command == "cache-stats" && words.size() != 1)
+        throw runtime_error("usage: cache-stats");
+    if (command == "cache-warm")
+    {
+        if (words.size() > 2)
+            throw runtime_error("usage: cache-warm [k]");
+        // The cache is not part of the version's data, so warming a shared snapshot is fine
+        graph.warmRecommendationCache(words.size() == 2 ? stoul(words[1]) : 10);
+    }
+
+    RecommendationCacheStats stats = graph.getRecommendationCacheStats();
+    stringstream ss;
+    beginResult(ss, command);
+    ss << ",\"entries\":" << stats.entries << ",\"hits\":" << stats.hits << ",\"misses\":" << stats.misses
+       << ",\"invalidations\":" << stats.invalidations << '}';
+    return ss.str();
+}
+
+string CommandRunner::search(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    const UserStore &users = *snapshot.users;
+    if (words.size() < 3)
+        throw runtime_error("usage: search <name|location|interest>[:kmp|:rabin-karp|:simd] <pattern>");
+
+    // An optional suffix on the field picks the matching algorithm, KMP by default
+    string fieldName = words[1], algorithmName = "kmp";
+    size_t colon = fieldName.find(':');
+    if (colon != string::npos)
+    {
+        algorithmName = fieldName.substr(colon + 1);
+        fieldName.erase(colon);
+    }
+
+    SearchField field;
+    if (fieldName == "name")
+        field = SearchField::NAME;
+    else if (fieldName == "location")
+        field = SearchField::LOCATION;
+    else if (fieldName == "interest")
+        field = SearchField::INTEREST;
+    else
+        throw runtime_error("unknown field " + fieldName);
+
+    SearchAlgorithm algorithm;
+    if (algorithmName == "kmp")
+        algorithm = SearchAlgorithm::KMP;
+    else if (algorithmName == "rabin-karp")
+        algorithm = SearchAlgorithm::RABIN_KARP;
+    else if (algorithmName == "simd")
+        algorithm = SearchAlgorithm::SIMD;
+    else
+        throw runtime_error("unknown algorithm " + algorithmName);
+
+    // The pattern is the rest of the line, so it may contain spaces
+    string pattern = words[2];
+    for (size_t i = 3; i < words.size(); i++)
+    {
+        pattern += ' ' + words[i];
+    }
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"field\":";
+    writeJsonString(ss, fieldName);
+    ss << ",\"algorithm\":";
+    writeJsonString(ss, algorithm == SearchAlgorithm::SIMD ? string("simd-") + StringSearch::getSIMDKernelName() : algorithmName);
+    ss << ",\"pattern\":";
+    writeJsonString(ss, pattern);
+    ss << ",\"results\":[";
+    bool first = true;
+    for (const ConstUser &user : StringSearch::parallelSearchUsers(users, field, pattern, algorithm))
+    {
+        if (!first)
+            ss << ',';
+        writeUser(ss, user);
+        first = false;
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+string CommandRunner::fuzzySearch(const vector<string> &words, const shared_ptr<const NetworkSnapshot> &snapshot)
+{
+    if (words.size() < 3)
+        throw runtime_error("usage: fuzzy <max-typos> <name>");
+    int maxDistance = stoi(words[1]);
+    if (maxDistance < 0)
+        throw runtime_error("max-typos must not be negative");
+    string pattern = words[2];
+    for (size_t i = 3; i < words.size(); i++)
+    {
+        pattern += ' ' + words[i];
+    }
+
+    // One index per version, so a query costs a bigram lookup rather than a scan of every name
+    auto index = fuzzyNameIndexes.get(snapshot, [](const NetworkSnapshot &indexed)
+                                      { return make_shared<const FuzzyNameIndex>(*indexed.users); });
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"pattern\":";
+    writeJsonString(ss, pattern);
+    ss << ",\"results\":[";
+    bool first = true;
+    for (const auto &match : index.value->search(pattern, maxDistance))
+    {
+        if (!first)
+            ss << ',';
+        ss << "{\"typos\":" << match.distance << ",\"user\":";
+        writeUser(ss, match.user);
+        ss << '}';
+        first = false;
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+// Adds one add-user, remove-user, connect or disconnect command to the update
+static void addMutation(const vector<string> &words, NetworkUpdate &update)
+{
+    const string &command = words[0];
+    if (command == "remove-user")
+    {
+        if (words.size() != 2)
+            throw runtime_error("usage: remove-user <id>");
+        update.removeUser(words[1]);
+    }
+    else if (command == "add-user")
+    {
+        if (words.size() < 3)
+            throw runtime_error("usage: add-user <id> <name> [age] [location] [interest...]");
+        int age = words.size() > 3 ? stoi(words[3]) : 0;
+        string location = words.size() > 4 ? words[4] : "";
+        vector<string> interests(words.begin() + min<size_t>(words.size(), 5), words.end());
+        update.addUser(words[1], words[2], age, location, interests);
+    }
+    else if (command == "connect" || command == "disconnect")
+    {
+        if (words.size() != 3)
+            throw runtime_error("usage: " + command + " <id> <id>");
+        if (command == "connect")
+            update.addConnection(words[1], words[2]);
+        else
+            update.removeConnection(words[1], words[2]);
+    }
+    else
+    {
+        throw runtime_error(command + " cannot be part of a batch");
+    }
+}
+
+string CommandRunner::mutate(const vector<string> &words)
+{
+    const string &command = words[0];
+    NetworkUpdate update;
+    VertexOrder order = VertexOrder::BFS;
+    if (command == "compact" || command == "compress")
+    {
+        if (words.size() != 1)
+            throw runtime_error("usage: " + command);
+    }
+    else if (command == "reorder")
+    {
+        if (words.size() != 2)
+            throw runtime_error("usage: reorder <bfs|degree|rcm>");
+        order = parseVertexOrder(words[1]);
+    }
+    else if (command == "batch")
+    {
+        // Commands separated by ";" (a word of its own or ending the last argument),
+        // published together as one version
+        vector<string> mutation;
+        for (size_t i = 1; i <= words.size(); i++)
+        {
+            bool last = i == words.size();
+            string word = last ? ";" : words[i];
+            bool ends = !word.empty() && word.back() == ';';
+            if (ends)
+                word.pop_back();
+            if (!word.empty())
+                mutation.push_back(word);
+            if ((ends || last) && !mutation.empty())
+            {
+                addMutation(mutation, update);
+                mutation.clear();
+            }
+        }
+        if (update.empty())
+            throw runtime_error("usage: batch <command> [args] ; <command> [args] ...");
+    }
+    else
+    {
+        addMutation(words, update);
+    }
+
+    unsigned long long version;
+    if (command == "compress")
+        version = network.compressAdjacency();
+    else if (command == "compact" || command == "reorder")
+        version = network.compact(order);
+    else
+        version = network.commit(update);
+
+    stringstream ss;
+    beginResult(ss, command);
+    if (command == "batch")
+        ss << ",\"mutations\":" << update.size();
+    ss << ",\"version\":" << version << '}';
+    return ss.str();
+}
+
+string CommandRunner::benchmark(const vector<string> &words, const NetworkSnapshot &snapshot)
+{
+    if (words.size() > 2)
+        throw runtime_error("usage: benchmark [sources]");
+    size_t sourceCount = words.size() == 2 ? stoul(words[1]) : 32;
+    const Graph &graph = snapshot.graph;
+    if (graph.getUserCount() == 0)
+        throw runtime_error("no users loaded");
+
+    // The same users, spread over the current numbering, start the traversals in every order
+    vector<string> ids = graph.getUsers();
+    sourceCount = max<size_t>(1, min(sourceCount, ids.size()));
+    vector<string> sources;
+    for (size_t i = 0; i < sourceCount; i++)
+    {
+        sources.push_back(ids[i * ids.size() / sourceCount]);
+    }
+
+    struct Variant
+    {
+        const char *name;
+        bool reorder;
+        VertexOrder order;
+        bool compress;
+    };
+    const Variant variants[] = {{"current", false, VertexOrder::BFS, false},
+                                {"bfs", true, VertexOrder::BFS, false},
+                                {"degree", true, VertexOrder::DEGREE, false},
+                                {"rcm", true, VertexOrder::REVERSE_CUTHILL_MCKEE, false},
+                                {"rcm+compressed", true, VertexOrder::REVERSE_CUTHILL_MCKEE, true}};
+
+    stringstream ss;
+    beginResult(ss, words[0]);
+    ss << ",\"users\":" << graph.getUserCount() << ",\"sources\":" << sources.size() << ",\"results\":[";
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+    {
+        Graph copy = graph;
+        if (variants[v].reorder)
+            copy.compact(variants[v].order);
+        if (variants[v].compress)
+            copy.compressAdjacency();
+
+        vector<int> distance;
+        size_t checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (const string &source : sources)
+        {
+            checksum += traverseFrom(copy, copy.getUserIndex(source), distance);
+        }
+        auto traversed = chrono::steady_clock::now();
+        for (const string &source : sources)
+        {
+            checksum += copy.getFriendRecommendations(source).size();
+        }
+        auto recommended = chrono::steady_clock::now();
+
+        if (v > 0)
+            ss << ',';
+        ss << "{\"order\":\"" << variants[v].name << "\",\"bfs_ms\":"
+           << chrono::duration<double, milli>(traversed - start).count() << ",\"recommend_ms\":"
+           << chrono::duration<double, milli>(recommended - traversed).count() << ",\"adjacency_bytes\":" << copy.getAdjacencyBytes()
+           << ",\"checksum\":" << checksum << '}';
+    }
+    ss << "]}";
+    return ss.str();
+}
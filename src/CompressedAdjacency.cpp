@@ -0,0 +1,98 @@
+#include "../include/CompressedAdjacency.hpp"
+#include <algorithm>
+
+using namespace std;
+
+CompressedAdjacency::CompressedAdjacency() {}
+
+void CompressedAdjacency::appendVarint(vector<unsigned char> &out, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+void CompressedAdjacency::build(const ChunkedVector<vector<int>> &lists, const vector<char> &removed)
+{
+    clear();
+    offsets.reserve(lists.size() + 1);
+
+    vector<int> sorted;
+    for (size_t vertex = 0; vertex < lists.size(); vertex++)
+    {
+        offsets.push_back(bytes.size());
+
+        sorted.clear();
+        if (!removed[vertex])
+        {
+            for (int neighbor : lists[vertex])
+            {
+                if (!removed[neighbor])
+                    sorted.push_back(neighbor);
+            }
+            sort(sorted.begin(), sorted.end());
+        }
+
+        appendVarint(bytes, sorted.size());
+        if (sorted.empty())
+            continue;
+
+        int first = sorted[0] - (int)vertex;
+        appendVarint(bytes, first >= 0 ? (unsigned int)first << 1 : ((unsigned int)(-first) << 1) - 1);
+        for (size_t i = 1; i < sorted.size(); i++)
+        {
+            appendVarint(bytes, sorted[i] - sorted[i - 1] - 1);
+        }
+    }
+    offsets.push_back(bytes.size());
+    bytes.shrink_to_fit();
+}
+
+void CompressedAdjacency::clear()
+{
+    vector<unsigned char>().swap(bytes);
+    vector<size_t>().swap(offsets);
+}
+
+size_t CompressedAdjacency::getVertexCount() const
+{
+    return offsets.empty() ? 0 : offsets.size() - 1;
+}
+
+size_t CompressedAdjacency::degree(int vertex) const
+{
+    unsigned int count;
+    readVarint(bytes.data() + offsets[vertex], count);
+    return count;
+}
+
+NeighborRange CompressedAdjacency::neighbors(int vertex) const
+{
+    unsigned int count;
+    const unsigned char *in = readVarint(bytes.data() + offsets[vertex], count);
+    if (count == 0)
+        return NeighborRange(in, 0, 0);
+
+    unsigned int zigzag;
+    in = readVarint(in, zigzag);
+    int first = vertex + ((zigzag & 1) ? -(int)((zigzag + 1) >> 1) : (int)(zigzag >> 1));
+    return NeighborRange(in, first, count);
+}
+
+bool CompressedAdjacency::contains(int vertex, int neighbor) const
+{
+    for (int candidate : neighbors(vertex))
+    {
+        if (candidate >= neighbor)
+            return candidate == neighbor;
+    }
+    return false;
+}
+
+size_t CompressedAdjacency::getBytesUsed() const
+{
+    return bytes.capacity() + offsets.capacity() * sizeof(size_t);
+}
@@ -0,0 +1,149 @@
+#include "../include/FuzzyNameIndex.hpp"
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+FuzzyNameIndex::FuzzyNameIndex(const UserStore &indexedUsers)
+    : users(indexedUsers), indexedCount(indexedUsers.size())
+{
+    const StringColumn &names = users.getNames();
+    for (size_t row = 0; row < indexedCount; row++)
+    {
+        for (unsigned int gram : distinctGrams(names[row]))
+        {
+            gramPostings[gram].push_back(row);
+        }
+        for (unsigned int key : characterKeys(names[row]))
+        {
+            characterPostings[key].push_back(row);
+        }
+    }
+}
+
+vector<unsigned int> FuzzyNameIndex::distinctGrams(string_view text)
+{
+    vector<unsigned int> grams;
+    for (size_t i = 0; i + GRAM_LENGTH <= text.length(); i++)
+    {
+        unsigned int gram = 0;
+        for (int j = 0; j < GRAM_LENGTH; j++)
+        {
+            gram = (gram << 8) | (unsigned char)tolower((unsigned char)text[i + j]);
+        }
+        grams.push_back(gram);
+    }
+
+    sort(grams.begin(), grams.end());
+    grams.erase(unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+vector<unsigned int> FuzzyNameIndex::characterKeys(string_view text)
+{
+    unsigned int occurrences[256] = {};
+    vector<unsigned int> keys;
+    for (char c : text)
+    {
+        unsigned char folded = tolower((unsigned char)c);
+        keys.push_back(++occurrences[folded] << 8 | folded);
+    }
+    return keys;
+}
+
+vector<unsigned int> FuzzyNameIndex::rowsSharing(const unordered_map<unsigned int, vector<unsigned int>> &postings,
+                                                 const vector<unsigned int> &keys, int threshold) const
+{
+    vector<unsigned short> counters;
+    {
+        lock_guard<mutex> lock(countersMutex);
+        if (spareCounters.empty())
+        {
+            counters.assign(indexedCount, 0);
+        }
+        else
+        {
+            counters = move(spareCounters.back());
+            spareCounters.pop_back();
+        }
+    }
+
+    vector<unsigned int> touched, rows;
+    for (unsigned int key : keys)
+    {
+        auto it = postings.find(key);
+        if (it == postings.end())
+            continue;
+
+        for (unsigned int row : it->second)
+        {
+            if (counters[row] == 0)
+                touched.push_back(row);
+            if (++counters[row] == threshold)
+                rows.push_back(row);
+        }
+    }
+
+    for (unsigned int row : touched)
+    {
+        counters[row] = 0;
+    }
+    {
+        lock_guard<mutex> lock(countersMutex);
+        spareCounters.push_back(move(counters));
+    }
+
+    sort(rows.begin(), rows.end());
+    return rows;
+}
+
+vector<StringSearch::FuzzyMatch> FuzzyNameIndex::search(const string &searchPattern, int maxDistance) const
+{
+    if (searchPattern.empty())
+        return {};
+
+    vector<unsigned int> patternGrams = distinctGrams(searchPattern);
+    int threshold = (int)patternGrams.size() - maxDistance * GRAM_LENGTH;
+    int sharedCharacters = (int)searchPattern.length() - maxDistance;
+
+    // The work is the length of the posting lists read. Common characters are listed
+    // under most users, so a character count can cost pattern length * users
+    // increments; it pays off by leaving fewer names to verify.
+    vector<unsigned int> candidates;
+    if (threshold > 0)
+    {
+        candidates = rowsSharing(gramPostings, patternGrams, threshold);
+    }
+    else if (sharedCharacters > 0)
+    {
+        candidates = rowsSharing(characterPostings, characterKeys(searchPattern), sharedCharacters);
+    }
+    else
+    {
+        // Every name is within pattern length edits
+        for (size_t row = 0; row < indexedCount; row++)
+        {
+            candidates.push_back(row);
+        }
+    }
+
+    vector<StringSearch::FuzzyMatch> results;
+    StringSearch::ApproximatePattern pattern(searchPattern);
+    for (unsigned int row : candidates)
+    {
+        int distance = pattern.distance(users.getNames()[row]);
+        if (distance <= maxDistance)
+        {
+            results.push_back({users[row], distance});
+        }
+    }
+
+    stable_sort(results.begin(), results.end(), [](const StringSearch::FuzzyMatch &a, const StringSearch::FuzzyMatch &b)
+                { return a.distance < b.distance; });
+    return results;
+}
+
+size_t FuzzyNameIndex::getUserCount() const
+{
+    return indexedCount;
+}
@@ -1,32 +1,505 @@
 #include "../include/Graph.hpp"
+#include "../include/ThreadPool.hpp"
 #include <algorithm>
 #include <limits>
 #include <stack>
 
 using namespace std;
 
-Graph::Graph() {}
+Graph::Graph()
+    : userCount(0), connectionCount(0), staleEntries(0),
+      compressed(false) {}
+
+void Graph::ownIndices()
+{
+    unordered_map<string, int> &indices = sharedIndices.write();
+    for (const string &userId : removedIndices)
+    {
+        auto it = indices.find(userId);
+        if (it != indices.end() && (removed[it->second] || users[it->second] != userId))
+            indices.erase(it);
+    }
+    for (const auto &entry : addedIndices)
+    {
+        indices[entry.first] = entry.second;
+    }
+    addedIndices.clear();
+    removedIndices.clear();
+}
+
+void Graph::indexUser(const string &userId, int vertex)
+{
+    if (!sharedIndices.isShared() || addedIndices.size() + removedIndices.size() >= sharedIndices->size() / 8)
+    {
+        ownIndices();
+        sharedIndices.write()[userId] = vertex;
+    }
+    else
+    {
+        addedIndices[userId] = vertex;
+    }
+}
+
+void Graph::unindexUser(const string &userId)
+{
+    if (addedIndices.erase(userId))
+        return;
+    if (!sharedIndices.isShared() || addedIndices.size() + removedIndices.size() >= sharedIndices->size() / 8)
+    {
+        ownIndices();
+        sharedIndices.write().erase(userId);
+    }
+    else
+    {
+        removedIndices.push_back(userId);
+    }
+}
+
+int Graph::findPosition(int vertex, int neighbor) const
+{
+    auto hub = hubPositions.find(vertex);
+    if (hub != hubPositions.end())
+    {
+        auto it = hub->second.find(neighbor);
+        return it == hub->second.end() ? -1 : (int)it->second;
+    }
+
+    const vector<int> &list = neighbors[vertex];
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        if (list[i] == neighbor)
+            return i;
+    }
+    return -1;
+}
+
+void Graph::insertNeighbor(int vertex, int neighbor)
+{
+    vector<int> &list = neighbors.at(vertex);
+    list.push_back(neighbor);
+
+    auto hub = hubPositions.find(vertex);
+    if (hub != hubPositions.end())
+    {
+        hub->second[neighbor] = list.size() - 1;
+    }
+    else if (list.size() > HUB_DEGREE)
+    {
+        unordered_map<int, unsigned int> &positions = hubPositions[vertex];
+        positions.reserve(list.size() * 2);
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            positions[list[i]] = i;
+        }
+    }
+}
+
+void Graph::eraseNeighbor(int vertex, int neighbor)
+{
+    int position = findPosition(vertex, neighbor);
+    if (position < 0)
+        return;
+
+    vector<int> &list = neighbors.at(vertex);
+    int last = list.back();
+    list[position] = last;
+    list.pop_back();
+
+    auto hub = hubPositions.find(vertex);
+    if (hub != hubPositions.end())
+    {
+        hub->second[last] = position;
+        hub->second.erase(neighbor);
+        // Half the threshold, so a degree hovering around it does not rebuild the index each time
+        if (list.size() < HUB_DEGREE / 2)
+            hubPositions.erase(hub);
+    }
+}
 
 void Graph::addUser(const string &userId)
 {
-    if (adjacencyList.find(userId) == adjacencyList.end())
+    if (hasUser(userId))
+        return;
+    expand();
+
+    if (freeVertices.empty() && !pendingPurge.empty())
+        purgeRemoved();
+
+    if (!freeVertices.empty())
+    {
+        int vertex = freeVertices.back();
+        freeVertices.pop_back();
+        users.at(vertex) = userId;
+        removed[vertex] = 0;
+        indexUser(userId, vertex);
+        userCount++;
+        return;
+    }
+
+    indexUser(userId, users.size());
+    users.push_back(userId);
+    neighbors.push_back({});
+    removed.push_back(0);
+    userCount++;
+}
+
+bool Graph::removeUser(const string &userId)
+{
+    int vertex = getUserIndex(userId);
+    if (vertex < 0)
+        return false;
+
+    expand();
+    // The user was a friend of a friend to everyone two hops away
+    invalidateRecommendations(vertex, 2);
+    users.at(vertex).clear();
+    removed[vertex] = 1;
+    unindexUser(userId);
+    userCount--;
+
+    // The neighbours' lists are left alone; only the live connections are counted off
+    for (int neighbor : neighbors[vertex])
     {
-        adjacencyList[userId] = vector<string>();
+        if (!removed[neighbor])
+            connectionCount--;
+    }
+    pendingPurge.push_back(vertex);
+    staleEntries += neighbors[vertex].size();
 
-        // Update users and indices
-        userIndices[userId] = users.size();
-        users.push_back(userId);
+    if (staleEntries > 2 * connectionCount)
+        purgeRemoved();
+    return true;
+}
 
-        // Update adjacency matrix
-        size_t newSize = users.size();
-        adjacencyMatrix.resize(newSize);
-        for (auto &row : adjacencyMatrix)
+void Graph::purgeRemoved()
+{
+    for (int vertex : pendingPurge)
+    {
+        for (int neighbor : neighbors[vertex])
         {
-            row.resize(newSize, numeric_limits<int>::max());
+            if (!removed[neighbor])
+                eraseNeighbor(neighbor, vertex);
         }
-        // Set diagonal to 0
-        adjacencyMatrix[newSize - 1][newSize - 1] = 0;
+        vector<int>().swap(neighbors.at(vertex));
+        hubPositions.erase(vertex);
+        freeVertices.push_back(vertex);
     }
+    pendingPurge.clear();
+    staleEntries = 0;
+}
+
+vector<int> Graph::liveDegrees() const
+{
+    vector<int> degrees(users.size(), 0);
+    for (size_t vertex = 0; vertex < users.size(); vertex++)
+    {
+        if (removed[vertex])
+            continue;
+        for (int neighbor : getNeighbors(vertex))
+        {
+            if (!removed[neighbor])
+                degrees[vertex]++;
+        }
+    }
+    return degrees;
+}
+
+vector<int> Graph::computeOrder(VertexOrder order) const
+{
+    vector<int> roots;
+    roots.reserve(userCount);
+    for (size_t vertex = 0; vertex < users.size(); vertex++)
+    {
+        if (!removed[vertex])
+            roots.push_back(vertex);
+    }
+
+    vector<int> degrees;
+    if (order != VertexOrder::BFS)
+        degrees = liveDegrees();
+
+    if (order == VertexOrder::DEGREE)
+    {
+        stable_sort(roots.begin(), roots.end(), [&degrees](int a, int b)
+                    { return degrees[a] > degrees[b]; });
+        return roots;
+    }
+
+    bool cuthillMcKee = order == VertexOrder::REVERSE_CUTHILL_MCKEE;
+    if (cuthillMcKee)
+    {
+        // Low-degree roots sit on the periphery, which keeps the BFS levels narrow
+        stable_sort(roots.begin(), roots.end(), [&degrees](int a, int b)
+                    { return degrees[a] < degrees[b]; });
+    }
+
+    vector<char> placed(users.size(), 0);
+    vector<int> result;
+    result.reserve(roots.size());
+    for (int root : roots)
+    {
+        if (placed[root])
+            continue;
+
+        placed[root] = 1;
+        result.push_back(root);
+        for (size_t head = result.size() - 1; head < result.size(); head++)
+        {
+            size_t levelStart = result.size();
+            for (int neighbor : getNeighbors(result[head]))
+            {
+                if (!removed[neighbor] && !placed[neighbor])
+                {
+                    placed[neighbor] = 1;
+                    result.push_back(neighbor);
+                }
+            }
+            if (cuthillMcKee)
+            {
+                stable_sort(result.begin() + levelStart, result.end(), [&degrees](int a, int b)
+                            { return degrees[a] < degrees[b]; });
+            }
+        }
+    }
+
+    if (cuthillMcKee)
+        reverse(result.begin(), result.end());
+    return result;
+}
+
+void Graph::compact(VertexOrder vertexOrder)
+{
+    vector<int> order = computeOrder(vertexOrder);
+    vector<int> newIndex(users.size(), -1);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        newIndex[order[i]] = i;
+    }
+
+    vector<string> newUsers(order.size());
+    vector<vector<int>> newNeighbors(order.size());
+    unordered_map<string, int> indices;
+    indices.reserve(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        newUsers[i] = users[order[i]];
+        indices[newUsers[i]] = i;
+        // Allocated in the new order and sorted, so a traversal walks memory forwards
+        newNeighbors[i].reserve(compressed ? packed.degree(order[i]) : neighbors[order[i]].size());
+        for (int neighbor : getNeighbors(order[i]))
+        {
+            if (!removed[neighbor])
+                newNeighbors[i].push_back(newIndex[neighbor]);
+        }
+        sort(newNeighbors[i].begin(), newNeighbors[i].end());
+    }
+
+    users.assign(move(newUsers));
+    neighbors.assign(move(newNeighbors));
+    sharedIndices = CopyOnWrite<unordered_map<string, int>>(move(indices));
+    addedIndices.clear();
+    removedIndices.clear();
+    recommendationCache.remap(newIndex);
+    removed.assign(users.size(), 0);
+    pendingPurge.clear();
+    staleEntries = 0;
+    freeVertices.clear();
+
+    if (compressed)
+    {
+        packed.clear();
+        compressed = false;
+        compressAdjacency();
+    }
+    else
+    {
+        rebuildHubPositions();
+    }
+}
+
+void Graph::rebuildHubPositions()
+{
+    hubPositions.clear();
+    for (size_t vertex = 0; vertex < neighbors.size(); vertex++)
+    {
+        if (neighbors[vertex].size() > HUB_DEGREE)
+        {
+            unordered_map<int, unsigned int> &positions = hubPositions[vertex];
+            positions.reserve(neighbors[vertex].size() * 2);
+            for (size_t i = 0; i < neighbors[vertex].size(); i++)
+            {
+                positions[neighbors[vertex][i]] = i;
+            }
+        }
+    }
+}
+
+void Graph::compressAdjacency()
+{
+    if (compressed)
+        return;
+
+    purgeRemoved();
+    packed.build(neighbors, removed);
+    neighbors.clear();
+    hubPositions.clear();
+    compressed = true;
+}
+
+void Graph::expand()
+{
+    if (!compressed)
+        return;
+
+    neighbors.clear();
+    for (size_t vertex = 0; vertex < users.size(); vertex++)
+    {
+        vector<int> list;
+        list.reserve(packed.degree(vertex));
+        for (int neighbor : packed.neighbors(vertex))
+        {
+            list.push_back(neighbor);
+        }
+        neighbors.push_back(move(list));
+    }
+    packed.clear();
+    compressed = false;
+    rebuildHubPositions();
+}
+
+bool Graph::isCompressed() const
+{
+    return compressed;
+}
+
+size_t Graph::getAdjacencyBytes() const
+{
+    if (compressed)
+        return packed.getBytesUsed();
+
+    size_t bytes = neighbors.getChunkCount() * sizeof(CopyOnWrite<vector<vector<int>>>);
+    for (size_t vertex = 0; vertex < neighbors.size(); vertex++)
+    {
+        bytes += sizeof(vector<int>) + neighbors[vertex].capacity() * sizeof(int);
+    }
+    for (const auto &hub : hubPositions)
+    {
+        // Bucket array plus one node (next pointer, key, value, cached hash) per entry
+        bytes += hub.second.bucket_count() * sizeof(void *) + hub.second.size() * 4 * sizeof(void *);
+    }
+    return bytes;
+}
+
+Graph Graph::inducedSubgraph(const vector<int> &vertices) const
+{
+    // A small subgraph is renumbered through a hash map, so nothing the size of the whole
+    // graph is allocated; a large one through a flat array, which is much faster to probe
+    bool dense = vertices.size() * 8 >= users.size();
+    unordered_map<int, int> sparseIndex;
+    vector<int> denseIndex;
+    if (dense)
+        denseIndex.assign(users.size(), -1);
+    else
+        sparseIndex.reserve(vertices.size());
+    auto newIndex = [&](int vertex)
+    {
+        if (dense)
+            return denseIndex[vertex];
+        auto it = sparseIndex.find(vertex);
+        return it == sparseIndex.end() ? -1 : it->second;
+    };
+
+    vector<int> members;
+    members.reserve(vertices.size());
+    for (int vertex : vertices)
+    {
+        if (vertex < 0 || vertex >= (int)users.size() || removed[vertex] || newIndex(vertex) >= 0)
+            continue;
+        if (dense)
+            denseIndex[vertex] = members.size();
+        else
+            sparseIndex[vertex] = members.size();
+        members.push_back(vertex);
+    }
+
+    Graph subgraph;
+    unordered_map<string, int> &subgraphIndices = subgraph.sharedIndices.write();
+    subgraphIndices.reserve(members.size());
+    subgraph.removed.assign(members.size(), 0);
+    subgraph.userCount = members.size();
+
+    size_t entries = 0;
+    for (size_t i = 0; i < members.size(); i++)
+    {
+        int vertex = members[i];
+        subgraphIndices[users[vertex]] = i;
+        subgraph.users.push_back(users[vertex]);
+
+        vector<int> list;
+        if (!compressed && neighbors[vertex].size() > members.size() && hubPositions.count(vertex) != 0)
+        {
+            // An indexed hub answers membership in O(1), so probe the members rather than walk its list
+            for (size_t j = 0; j < members.size(); j++)
+            {
+                if (j != i && findPosition(vertex, members[j]) >= 0)
+                    list.push_back(j);
+            }
+        }
+        else
+        {
+            for (int neighbor : getNeighbors(vertex))
+            {
+                int index = newIndex(neighbor);
+                if (index >= 0)
+                    list.push_back(index);
+            }
+            sort(list.begin(), list.end());
+        }
+        entries += list.size();
+        subgraph.neighbors.push_back(move(list));
+    }
+
+    subgraph.connectionCount = entries / 2;
+    subgraph.rebuildHubPositions();
+    return subgraph;
+}
+
+Graph Graph::inducedSubgraph(const vector<string> &userIds) const
+{
+    vector<int> vertices;
+    vertices.reserve(userIds.size());
+    for (const string &userId : userIds)
+    {
+        vertices.push_back(getUserIndex(userId));
+    }
+    return inducedSubgraph(vertices);
+}
+
+Graph Graph::egoNetwork(const string &userId, int hops) const
+{
+    int center = getUserIndex(userId);
+    if (center < 0)
+        return Graph();
+
+    // The BFS queue doubles as the member list: the vertices in the order they were reached
+    unordered_map<int, int> distance;
+    vector<int> members;
+    distance[center] = 0;
+    members.push_back(center);
+    for (size_t head = 0; head < members.size(); head++)
+    {
+        int current = members[head];
+        int currentDistance = distance[current];
+        if (currentDistance >= hops)
+            continue;
+
+        for (int neighbor : getNeighbors(current))
+        {
+            if (!removed[neighbor] && distance.emplace(neighbor, currentDistance + 1).second)
+                members.push_back(neighbor);
+        }
+    }
+    return inducedSubgraph(members);
 }
 
 void Graph::addConnection(const string &user1, const string &user2)
@@ -38,74 +511,157 @@ void Graph::addConnection(const string &user1, const string &user2)
     addUser(user1);
     addUser(user2);
 
-    // Update adjacency list
-    if (std::find(adjacencyList[user1].begin(), adjacencyList[user1].end(), user2) == adjacencyList[user1].end())
+    expand();
+    int u = getUserIndex(user1);
+    int v = getUserIndex(user2);
+    if (!areConnected(u, v))
     {
-        adjacencyList[user1].push_back(user2);
-        adjacencyList[user2].push_back(user1);
-
-        // Update adjacency matrix
-        int idx1 = userIndices[user1];
-        int idx2 = userIndices[user2];
-        adjacencyMatrix[idx1][idx2] = 1;
-        adjacencyMatrix[idx2][idx1] = 1;
+        insertNeighbor(u, v);
+        insertNeighbor(v, u);
+        connectionCount++;
+        invalidateRecommendations(u, 1);
+        invalidateRecommendations(v, 1);
     }
 }
 
 void Graph::removeConnection(const string &user1, const string &user2)
 {
-    if (adjacencyList.find(user1) != adjacencyList.end() && adjacencyList.find(user2) != adjacencyList.end())
+    int u = getUserIndex(user1);
+    int v = getUserIndex(user2);
+    if (u >= 0 && v >= 0 && areConnected(u, v))
     {
-        adjacencyList[user1].erase(
-            remove(adjacencyList[user1].begin(), adjacencyList[user1].end(), user2),
-            adjacencyList[user1].end());
-        adjacencyList[user2].erase(
-            remove(adjacencyList[user2].begin(), adjacencyList[user2].end(), user1),
-            adjacencyList[user2].end());
-
-        // Update adjacency matrix
-        int idx1 = userIndices[user1];
-        int idx2 = userIndices[user2];
-        adjacencyMatrix[idx1][idx2] = numeric_limits<int>::max();
-        adjacencyMatrix[idx2][idx1] = numeric_limits<int>::max();
+        expand();
+        invalidateRecommendations(u, 1);
+        invalidateRecommendations(v, 1);
+        eraseNeighbor(u, v);
+        eraseNeighbor(v, u);
+        connectionCount--;
     }
 }
 
 bool Graph::areConnected(const string &user1, const string &user2) const
 {
-    if (adjacencyList.find(user1) == adjacencyList.end() || adjacencyList.find(user2) == adjacencyList.end())
+    int u = getUserIndex(user1);
+    int v = getUserIndex(user2);
+    return u >= 0 && v >= 0 && areConnected(u, v);
+}
+
+bool Graph::areConnected(int vertex1, int vertex2) const
+{
+    if (compressed)
     {
-        return false;
+        return packed.degree(vertex1) <= packed.degree(vertex2) ? packed.contains(vertex1, vertex2)
+                                                                : packed.contains(vertex2, vertex1);
     }
-    return std::find(adjacencyList.at(user1).begin(), adjacencyList.at(user1).end(), user2) != adjacencyList.at(user1).end();
+
+    // Probe the shorter list unless the longer one is indexed
+    if (neighbors[vertex1].size() > neighbors[vertex2].size() && hubPositions.count(vertex1) == 0)
+        swap(vertex1, vertex2);
+    return findPosition(vertex1, vertex2) >= 0;
+}
+
+int Graph::getDegree(const string &userId) const
+{
+    int vertex = getUserIndex(userId);
+    return vertex < 0 ? 0 : getDegree(vertex);
+}
+
+int Graph::getDegree(int vertex) const
+{
+    if (removed[vertex])
+        return 0;
+    if (compressed)
+        return packed.degree(vertex);
+    if (pendingPurge.empty())
+        return neighbors[vertex].size();
+
+    int degree = 0;
+    for (int neighbor : neighbors[vertex])
+    {
+        if (!removed[neighbor])
+            degree++;
+    }
+    return degree;
+}
+
+int Graph::getUserIndex(const string &userId) const
+{
+    if (!addedIndices.empty())
+    {
+        auto added = addedIndices.find(userId);
+        if (added != addedIndices.end())
+            return added->second;
+    }
+
+    auto it = sharedIndices->find(userId);
+    if (it == sharedIndices->end())
+        return -1;
+    // Entries of users removed since the index was shared are stale
+    if (!removedIndices.empty() && (removed[it->second] || users[it->second] != userId))
+        return -1;
+    return it->second;
+}
+
+bool Graph::hasUser(const string &userId) const
+{
+    return getUserIndex(userId) >= 0;
+}
+
+const string &Graph::getUserId(int vertex) const
+{
+    return users[vertex];
+}
+
+NeighborRange Graph::getNeighbors(int vertex) const
+{
+    return compressed ? packed.neighbors(vertex) : NeighborRange(neighbors[vertex]);
+}
+
+bool Graph::isRemoved(int vertex) const
+{
+    return removed[vertex];
+}
+
+int Graph::getVertexCount() const
+{
+    return users.size();
+}
+
+bool Graph::hasTombstones() const
+{
+    return !pendingPurge.empty() || !freeVertices.empty();
 }
 
 vector<string> Graph::getFriendRecommendations(const string &userId, int depth) const
 {
     vector<string> recommendations;
-    set<string> visited;
-    queue<pair<string, int>> queue;
+    int start = getUserIndex(userId);
+    if (start < 0)
+        return recommendations;
+
+    vector<char> visited(users.size(), 0);
+    queue<pair<int, int>> queue;
 
-    visited.insert(userId);
-    queue.push({userId, 0});
+    visited[start] = 1;
+    queue.push({start, 0});
 
     while (!queue.empty())
     {
-        auto [currentUser, currentDepth] = queue.front();
+        auto [current, currentDepth] = queue.front();
         queue.pop();
 
         if (currentDepth >= depth)
             continue;
 
-        for (const auto &friend_ : adjacencyList.at(currentUser))
+        for (int friend_ : getNeighbors(current))
         {
-            if (visited.find(friend_) == visited.end())
+            if (!visited[friend_] && !removed[friend_])
             {
-                visited.insert(friend_);
+                visited[friend_] = 1;
                 queue.push({friend_, currentDepth + 1});
                 if (currentDepth > 0)
                 { // Don't include direct friends
-                    recommendations.push_back(friend_);
+                    recommendations.push_back(users[friend_]);
                 }
             }
         }
@@ -114,26 +670,124 @@ vector<string> Graph::getFriendRecommendations(const string &userId, int depth)
     return recommendations;
 }
 
+vector<int> Graph::rankRecommendations(int vertex, size_t k) const
+{
+    // Mutual friends with each friend of a friend, counted sparsely
+    unordered_map<int, int> mutualFriends;
+    for (int friend_ : getNeighbors(vertex))
+    {
+        if (removed[friend_])
+            continue;
+        for (int candidate : getNeighbors(friend_))
+        {
+            if (candidate != vertex && !removed[candidate])
+                mutualFriends[candidate]++;
+        }
+    }
+    for (int friend_ : getNeighbors(vertex))
+    {
+        mutualFriends.erase(friend_);
+    }
+
+    vector<pair<int, int>> candidates(mutualFriends.begin(), mutualFriends.end());
+    size_t count = min(k, candidates.size());
+    partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                 [this](const pair<int, int> &a, const pair<int, int> &b)
+                 { return a.second != b.second ? a.second > b.second : users[a.first] < users[b.first]; });
+
+    vector<int> ranking(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        ranking[i] = candidates[i].first;
+    }
+    return ranking;
+}
+
+void Graph::invalidateRecommendations(int vertex, int hops)
+{
+    if (recommendationCache.empty())
+        return;
+
+    vector<int> reached = {vertex};
+    unordered_map<int, int> distance = {{vertex, 0}};
+    for (size_t head = 0; head < reached.size(); head++)
+    {
+        int current = reached[head];
+        if (distance[current] >= hops)
+            continue;
+        for (int neighbor : getNeighbors(current))
+        {
+            if (!removed[neighbor] && distance.emplace(neighbor, distance[current] + 1).second)
+                reached.push_back(neighbor);
+        }
+    }
+    recommendationCache.invalidate(reached);
+}
+
+vector<string> Graph::getTopRecommendations(const string &userId, size_t k) const
+{
+    vector<string> recommendations;
+    int vertex = getUserIndex(userId);
+    if (vertex < 0)
+        return recommendations;
+
+    vector<int> ranking;
+    if (!recommendationCache.find(vertex, k, ranking))
+    {
+        ranking = rankRecommendations(vertex, k);
+        recommendationCache.store(vertex, k, ranking);
+    }
+
+    recommendations.reserve(ranking.size());
+    for (int recommended : ranking)
+    {
+        recommendations.push_back(users[recommended]);
+    }
+    return recommendations;
+}
+
+void Graph::warmRecommendationCache(size_t k) const
+{
+    ThreadPool &pool = ThreadPool::shared();
+    size_t grain = max<size_t>(64, users.size() / (pool.getThreadCount() * 16 + 1));
+    pool.parallelFor(0, users.size(), grain, [&](size_t begin, size_t end)
+                     {
+                         for (size_t vertex = begin; vertex < end; vertex++)
+                         {
+                             if (!removed[vertex])
+                                 recommendationCache.store(vertex, k, rankRecommendations(vertex, k));
+                         } });
+}
+
+RecommendationCacheStats Graph::getRecommendationCacheStats() const
+{
+    return recommendationCache.getStats();
+}
+
 vector<string> Graph::BFS(const string &startUser) const
 {
     vector<string> result;
-    set<string> visited;
-    queue<string> queue;
+    int start = getUserIndex(startUser);
+    if (start < 0)
+        return result;
+
+    vector<char> visited(users.size(), 0);
+    queue<int> queue;
 
-    visited.insert(startUser);
-    queue.push(startUser);
+    visited[start] = 1;
+    queue.push(start);
 
     while (!queue.empty())
     {
-        string current = queue.front();
+        int current = queue.front();
         queue.pop();
-        result.push_back(current);
+        result.push_back(users[current]);
 
-        for (const auto &neighbor : adjacencyList.at(current))
+        for (int neighbor : getNeighbors(current))
         {
-            if (visited.find(neighbor) == visited.end())
+            if (!visited[neighbor] && !removed[neighbor])
             {
-                visited.insert(neighbor);
+                visited[neighbor] = 1;
                 queue.push(neighbor);
             }
         }
@@ -142,41 +796,124 @@ vector<string> Graph::BFS(const string &startUser) const
     return result;
 }
 
-vector<string> Graph::DFS(const string &startUser) const
+void Graph::boundedBFS(const string &startUser, int maxHops, const function<bool(const string &, int)> &visit) const
 {
-    vector<string> result;
-    set<string> visited;
-    DFSUtil(startUser, visited, result);
-    return result;
+    int start = getUserIndex(startUser);
+    if (start < 0)
+        return;
+
+    // Only the reached vertices are recorded, so a small neighbourhood stays cheap
+    unordered_map<int, char> visited;
+    queue<pair<int, int>> queue;
+
+    visited[start] = 1;
+    queue.push({start, 0});
+
+    while (!queue.empty())
+    {
+        auto [current, hops] = queue.front();
+        queue.pop();
+
+        if (hops >= maxHops)
+            continue;
+
+        for (int neighbor : getNeighbors(current))
+        {
+            if (!removed[neighbor] && visited.emplace(neighbor, 1).second)
+            {
+                if (!visit(users[neighbor], hops + 1))
+                    return;
+                queue.push({neighbor, hops + 1});
+            }
+        }
+    }
 }
 
-void Graph::DFSUtil(const string &user, set<string> &visited, vector<string> &result) const
+int Graph::getDistance(const string &fromUser, const string &toUser) const
 {
-    visited.insert(user);
-    result.push_back(user);
+    int from = getUserIndex(fromUser);
+    int to = getUserIndex(toUser);
+    if (from < 0 || to < 0)
+        return -1;
+    if (from == to)
+        return 0;
+
+    vector<int> distance(users.size(), -1);
+    queue<int> queue;
+    distance[from] = 0;
+    queue.push(from);
 
-    for (const auto &neighbor : adjacencyList.at(user))
+    while (!queue.empty())
     {
-        if (visited.find(neighbor) == visited.end())
+        int current = queue.front();
+        queue.pop();
+
+        for (int neighbor : getNeighbors(current))
         {
-            DFSUtil(neighbor, visited, result);
+            if (distance[neighbor] < 0 && !removed[neighbor])
+            {
+                distance[neighbor] = distance[current] + 1;
+                if (neighbor == to)
+                    return distance[neighbor];
+                queue.push(neighbor);
+            }
         }
     }
+    return -1;
+}
+
+vector<string> Graph::DFS(const string &startUser) const
+{
+    vector<string> result;
+    int start = getUserIndex(startUser);
+    if (start < 0)
+        return result;
+
+    // Explicit stack of (next neighbour to look at, end of list): same order as the
+    // recursive version without its recursion depth limit
+    vector<char> visited(users.size(), 0);
+    stack<pair<NeighborRange::iterator, NeighborRange::iterator>> pending;
+
+    visited[start] = 1;
+    result.push_back(users[start]);
+    NeighborRange startNeighbors = getNeighbors(start);
+    pending.push({startNeighbors.begin(), startNeighbors.end()});
+
+    while (!pending.empty())
+    {
+        auto &[next, last] = pending.top();
+        if (next == last)
+        {
+            pending.pop();
+            continue;
+        }
+
+        int neighbor = *next;
+        ++next;
+        if (!visited[neighbor] && !removed[neighbor])
+        {
+            visited[neighbor] = 1;
+            result.push_back(users[neighbor]);
+            NeighborRange neighborList = getNeighbors(neighbor);
+            pending.push({neighborList.begin(), neighborList.end()});
+        }
+    }
+
+    return result;
 }
 
 vector<Graph::Edge> Graph::getAllEdges() const
 {
     vector<Edge> edges;
-    set<pair<string, string>> added;
+    edges.reserve(connectionCount);
 
-    for (const auto &[user, friends] : adjacencyList)
+    for (size_t user = 0; user < users.size(); user++)
     {
-        for (const auto &friend_ : friends)
+        for (int friend_ : getNeighbors(user))
         {
-            if (user < friend_ && added.find({user, friend_}) == added.end())
+            if ((int)user < friend_ && !removed[user] && !removed[friend_])
             {
                 edges.emplace_back(user, friend_, 1); // Using weight 1 for simplicity
-                added.insert({user, friend_});
             }
         }
     }
@@ -213,7 +950,7 @@ void Graph::unionSets(vector<int> &parent, vector<int> &rank, int x, int y)
     }
 }
 
-vector<vector<string>> Graph::detectCommunities(int threshold)
+vector<vector<string>> Graph::detectCommunities(int threshold) const
 {
     vector<Edge> edges = getAllEdges();
     sort(edges.begin(), edges.end(),
@@ -229,29 +966,29 @@ vector<vector<string>> Graph::detectCommunities(int threshold)
 
     for (const auto &edge : edges)
     {
-        int u = userIndices[edge.user1];
-        int v = userIndices[edge.user2];
-
-        if (find(parent, u) != find(parent, v))
+        if (find(parent, edge.user1) != find(parent, edge.user2))
         {
             if (edge.weight <= threshold)
             {
-                unionSets(parent, rank, u, v);
+                unionSets(parent, rank, edge.user1, edge.user2);
             }
         }
     }
 
-    unordered_map<int, vector<string>> communities;
+    // Communities in order of their first member
+    vector<int> communityOf(users.size(), -1);
+    vector<vector<string>> result;
     for (size_t i = 0; i < users.size(); i++)
     {
+        if (removed[i])
+            continue;
         int root = find(parent, i);
-        communities[root].push_back(users[i]);
-    }
-
-    vector<vector<string>> result;
-    for (const auto &community : communities)
-    {
-        result.push_back(community.second);
+        if (communityOf[root] < 0)
+        {
+            communityOf[root] = result.size();
+            result.emplace_back();
+        }
+        result[communityOf[root]].push_back(users[i]);
     }
 
     return result;
@@ -259,8 +996,28 @@ vector<vector<string>> Graph::detectCommunities(int threshold)
 
 vector<vector<int>> Graph::floydWarshall() const
 {
-    int V = users.size();
-    auto dist = adjacencyMatrix;
+    // Matrix positions skip removed vertices
+    vector<int> position(users.size(), -1);
+    int V = 0;
+    for (size_t vertex = 0; vertex < users.size(); vertex++)
+    {
+        if (!removed[vertex])
+            position[vertex] = V++;
+    }
+
+    vector<vector<int>> dist(V, vector<int>(V, numeric_limits<int>::max()));
+    for (size_t vertex = 0; vertex < users.size(); vertex++)
+    {
+        int i = position[vertex];
+        if (i < 0)
+            continue;
+        dist[i][i] = 0;
+        for (int neighbor : getNeighbors(vertex))
+        {
+            if (position[neighbor] >= 0)
+                dist[i][position[neighbor]] = 1;
+        }
+    }
 
     for (int k = 0; k < V; k++)
     {
@@ -281,17 +1038,24 @@ vector<vector<int>> Graph::floydWarshall() const
     return dist;
 }
 
-const unordered_map<string, vector<string>> &Graph::getAdjacencyList() const
+vector<string> Graph::getUsers() const
 {
-    return adjacencyList;
+    vector<string> live;
+    live.reserve(userCount);
+    for (size_t vertex = 0; vertex < users.size(); vertex++)
+    {
+        if (!removed[vertex])
+            live.push_back(users[vertex]);
+    }
+    return live;
 }
 
-const vector<string> &Graph::getUsers() const
+int Graph::getUserCount() const
 {
-    return users;
+    return userCount;
 }
 
-int Graph::getUserCount() const
+size_t Graph::getConnectionCount() const
 {
-    return users.size();
-}
\ No newline at end of file
+    return connectionCount;
+}
@@ -0,0 +1,649 @@
+#include "../include/GraphMetrics.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define GRAPH_METRICS_SSE2
+#endif
+
+using namespace std;
+
+// Work units per thread for parallelFor; degree skew makes chunk costs uneven
+static const size_t CHUNKS_PER_THREAD = 16;
+
+static size_t grainFor(size_t count)
+{
+    size_t chunks = ThreadPool::shared().getThreadCount() * CHUNKS_PER_THREAD;
+    return max<size_t>(64, (count + chunks - 1) / chunks);
+}
+
+// Calls onMatch(x) for every x in both strictly increasing arrays
+template <typename OnMatch>
+static void intersectSorted(const int *a, size_t aSize, const int *b, size_t bSize, OnMatch onMatch)
+{
+    size_t i = 0, j = 0;
+#ifdef GRAPH_METRICS_SSE2
+    // Compare blocks of four against all four rotations of the other block, then advance
+    // whichever block ends lower (both when they end on the same value)
+    while (i + 4 <= aSize && j + 4 <= bSize)
+    {
+        __m128i blockA = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i blockB = _mm_loadu_si128((const __m128i *)(b + j));
+        __m128i equal = _mm_cmpeq_epi32(blockA, blockB);
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1))));
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2))));
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        int matches = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        while (matches != 0)
+        {
+            onMatch(a[i + __builtin_ctz(matches)]);
+            matches &= matches - 1;
+        }
+
+        int lastA = a[i + 3], lastB = b[j + 3];
+        if (lastA <= lastB)
+            i += 4;
+        if (lastB <= lastA)
+            j += 4;
+    }
+#endif
+    while (i < aSize && j < bSize)
+    {
+        if (a[i] < b[j])
+            i++;
+        else if (b[j] < a[i])
+            j++;
+        else
+        {
+            onMatch(a[i]);
+            i++;
+            j++;
+        }
+    }
+}
+
+GraphMetrics::OrientedGraph GraphMetrics::orient(const Graph &graph)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    size_t n = graph.getVertexCount();
+    OrientedGraph oriented;
+
+    oriented.degrees.assign(n, 0);
+    pool.parallelFor(0, n, grainFor(n), [&](size_t begin, size_t end)
+                     {
+                         for (size_t vertex = begin; vertex < end; vertex++)
+                         {
+                             if (graph.isRemoved(vertex))
+                                 continue;
+                             for (int neighbor : graph.getNeighbors(vertex))
+                             {
+                                 if (!graph.isRemoved(neighbor))
+                                     oriented.degrees[vertex]++;
+                             }
+                         } });
+
+    for (size_t vertex = 0; vertex < n; vertex++)
+    {
+        if (!graph.isRemoved(vertex))
+            oriented.vertexOf.push_back(vertex);
+    }
+    const vector<unsigned int> &degrees = oriented.degrees;
+    sort(oriented.vertexOf.begin(), oriented.vertexOf.end(), [&degrees](int a, int b)
+         { return degrees[a] != degrees[b] ? degrees[a] < degrees[b] : a < b; });
+
+    size_t ranks = oriented.vertexOf.size();
+    vector<int> rankOf(n, -1);
+    for (size_t rank = 0; rank < ranks; rank++)
+    {
+        rankOf[oriented.vertexOf[rank]] = rank;
+    }
+
+    // Count, prefix-sum, then fill and sort each list in place
+    oriented.offsets.assign(ranks + 1, 0);
+    pool.parallelFor(0, ranks, grainFor(ranks), [&](size_t begin, size_t end)
+                     {
+                         for (size_t rank = begin; rank < end; rank++)
+                         {
+                             for (int neighbor : graph.getNeighbors(oriented.vertexOf[rank]))
+                             {
+                                 if (rankOf[neighbor] > (int)rank)
+                                     oriented.offsets[rank + 1]++;
+                             }
+                         } });
+    partial_sum(oriented.offsets.begin(), oriented.offsets.end(), oriented.offsets.begin());
+
+    oriented.targets.resize(oriented.offsets[ranks]);
+    pool.parallelFor(0, ranks, grainFor(ranks), [&](size_t begin, size_t end)
+                     {
+                         for (size_t rank = begin; rank < end; rank++)
+                         {
+                             int *out = oriented.targets.data() + oriented.offsets[rank];
+                             int *first = out;
+                             for (int neighbor : graph.getNeighbors(oriented.vertexOf[rank]))
+                             {
+                                 if (rankOf[neighbor] > (int)rank)
+                                     *out++ = rankOf[neighbor];
+                             }
+                             sort(first, out);
+                         } });
+
+    return oriented;
+}
+
+TriangleCounts GraphMetrics::countTriangles(const Graph &graph)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    OrientedGraph oriented = orient(graph);
+    size_t n = graph.getVertexCount();
+    size_t ranks = oriented.vertexOf.size();
+
+    // Indexed by rank; the other two corners of a triangle are credited from other chunks
+    unique_ptr<atomic<unsigned long long>[]> perRank(new atomic<unsigned long long>[ranks]());
+    atomic<unsigned long long> total(0);
+
+    pool.parallelFor(0, ranks, grainFor(ranks), [&](size_t begin, size_t end)
+                     {
+                         unsigned long long chunkTotal = 0;
+                         const int *targets = oriented.targets.data();
+                         for (size_t u = begin; u < end; u++)
+                         {
+                             const int *uList = targets + oriented.offsets[u];
+                             size_t uSize = oriented.offsets[u + 1] - oriented.offsets[u];
+                             unsigned long long uTriangles = 0;
+                             for (size_t k = 0; k < uSize; k++)
+                             {
+                                 int v = uList[k];
+                                 unsigned long long vTriangles = 0;
+                                 // Only entries after v can close a triangle, since w > v
+                                 intersectSorted(uList + k + 1, uSize - k - 1, targets + oriented.offsets[v],
+                                                 oriented.offsets[v + 1] - oriented.offsets[v], [&](int w)
+                                                 {
+                                                     vTriangles++;
+                                                     perRank[w].fetch_add(1, memory_order_relaxed); });
+                                 if (vTriangles > 0)
+                                     perRank[v].fetch_add(vTriangles, memory_order_relaxed);
+                                 uTriangles += vTriangles;
+                             }
+                             if (uTriangles > 0)
+                                 perRank[u].fetch_add(uTriangles, memory_order_relaxed);
+                             chunkTotal += uTriangles;
+                         }
+                         total.fetch_add(chunkTotal, memory_order_relaxed); });
+
+    TriangleCounts counts;
+    counts.total = total.load();
+    counts.perVertex.assign(n, 0);
+    counts.clustering.assign(n, 0.0);
+
+    double clusteringSum = 0;
+    double triples = 0;
+    for (size_t rank = 0; rank < ranks; rank++)
+    {
+        int vertex = oriented.vertexOf[rank];
+        unsigned long long triangles = perRank[rank].load();
+        double degree = oriented.degrees[vertex];
+        double pairs = degree * (degree - 1) / 2;
+
+        counts.perVertex[vertex] = triangles;
+        if (pairs > 0)
+            counts.clustering[vertex] = triangles / pairs;
+        clusteringSum += counts.clustering[vertex];
+        triples += pairs;
+    }
+    if (ranks > 0)
+        counts.averageClustering = clusteringSum / ranks;
+    if (triples > 0)
+        counts.transitivity = 3.0 * counts.total / triples;
+
+    return counts;
+}
+
+GraphMetrics::DenseGraph GraphMetrics::densify(const Graph &graph)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    size_t n = graph.getVertexCount();
+    DenseGraph dense;
+
+    vector<int> indexOf(n, -1);
+    for (size_t vertex = 0; vertex < n; vertex++)
+    {
+        if (!graph.isRemoved(vertex))
+        {
+            indexOf[vertex] = dense.vertexOf.size();
+            dense.vertexOf.push_back(vertex);
+        }
+    }
+
+    size_t size = dense.size();
+    dense.offsets.assign(size + 1, 0);
+    pool.parallelFor(0, size, grainFor(size), [&](size_t begin, size_t end)
+                     {
+                         for (size_t i = begin; i < end; i++)
+                         {
+                             for (int neighbor : graph.getNeighbors(dense.vertexOf[i]))
+                             {
+                                 if (indexOf[neighbor] >= 0)
+                                     dense.offsets[i + 1]++;
+                             }
+                         } });
+    partial_sum(dense.offsets.begin(), dense.offsets.end(), dense.offsets.begin());
+
+    dense.targets.resize(dense.offsets[size]);
+    pool.parallelFor(0, size, grainFor(size), [&](size_t begin, size_t end)
+                     {
+                         for (size_t i = begin; i < end; i++)
+                         {
+                             int *out = dense.targets.data() + dense.offsets[i];
+                             for (int neighbor : graph.getNeighbors(dense.vertexOf[i]))
+                             {
+                                 if (indexOf[neighbor] >= 0)
+                                     *out++ = indexOf[neighbor];
+                             }
+                         } });
+
+    return dense;
+}
+
+vector<double> GraphMetrics::toVertexOrder(const Graph &graph, const DenseGraph &dense, const vector<double> &values)
+{
+    vector<double> byVertex(graph.getVertexCount(), 0.0);
+    for (size_t i = 0; i < dense.size(); i++)
+    {
+        byVertex[dense.vertexOf[i]] = values[i];
+    }
+    return byVertex;
+}
+
+vector<double> GraphMetrics::pageRank(const Graph &graph, double damping, double tolerance, int maxIterations, int *iterations)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    DenseGraph dense = densify(graph);
+    size_t n = dense.size();
+    if (iterations)
+        *iterations = 0;
+    if (n == 0)
+        return vector<double>(graph.getVertexCount(), 0.0);
+
+    size_t grain = grainFor(n);
+    size_t chunks = (n + grain - 1) / grain;
+    vector<double> rank(n, 1.0 / n), next(n), share(n);
+    vector<double> partialDangling(chunks), partialChange(chunks);
+
+    for (int iteration = 0; iteration < maxIterations; iteration++)
+    {
+        // Each vertex's outgoing share, plus the rank held by users with no connections
+        pool.parallelFor(0, n, grain, [&](size_t begin, size_t end)
+                         {
+                             double dangling = 0;
+                             for (size_t i = begin; i < end; i++)
+                             {
+                                 size_t degree = dense.degree(i);
+                                 if (degree == 0)
+                                 {
+                                     dangling += rank[i];
+                                     share[i] = 0;
+                                 }
+                                 else
+                                 {
+                                     share[i] = rank[i] / degree;
+                                 }
+                             }
+                             partialDangling[begin / grain] = dangling; });
+
+        double dangling = accumulate(partialDangling.begin(), partialDangling.end(), 0.0);
+        double base = (1.0 - damping) / n + damping * dangling / n;
+
+        pool.parallelFor(0, n, grain, [&](size_t begin, size_t end)
+                         {
+                             double change = 0;
+                             for (size_t i = begin; i < end; i++)
+                             {
+                                 double sum = 0;
+                                 for (size_t e = dense.offsets[i]; e < dense.offsets[i + 1]; e++)
+                                 {
+                                     sum += share[dense.targets[e]];
+                                 }
+                                 next[i] = base + damping * sum;
+                                 change += fabs(next[i] - rank[i]);
+                             }
+                             partialChange[begin / grain] = change; });
+
+        rank.swap(next);
+        if (iterations)
+            *iterations = iteration + 1;
+        if (accumulate(partialChange.begin(), partialChange.end(), 0.0) < tolerance)
+            break;
+    }
+
+    return toVertexOrder(graph, dense, rank);
+}
+
+vector<double> GraphMetrics::betweenness(const Graph &graph, size_t samples, unsigned int seed)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    DenseGraph dense = densify(graph);
+    size_t n = dense.size();
+    vector<double> centrality(n, 0.0);
+    if (n == 0 || samples == 0)
+        return toVertexOrder(graph, dense, centrality);
+
+    // Distinct random sources: the head of a partial shuffle
+    samples = min(samples, n);
+    vector<int> sources(n);
+    iota(sources.begin(), sources.end(), 0);
+    mt19937 rng(seed);
+    for (size_t i = 0; i < samples; i++)
+    {
+        swap(sources[i], sources[i + rng() % (n - i)]);
+    }
+
+    // One chunk per thread, so each keeps a single set of O(n) buffers
+    size_t threads = pool.getThreadCount() + 1;
+    size_t grain = (samples + threads - 1) / threads;
+    mutex mergeMutex;
+    pool.parallelFor(0, samples, grain, [&](size_t begin, size_t end)
+                     {
+                         // Per-vertex search state packed together, so a visit touches one line
+                         struct PathState
+                         {
+                             int distance = -1;
+                             double paths = 0;      // Shortest paths from the source (sigma)
+                             double dependency = 0; // Brandes' delta
+                         };
+                         vector<PathState> state(n);
+                         vector<double> local(n, 0.0);
+                         vector<int> order;
+                         order.reserve(n);
+
+                         for (size_t s = begin; s < end; s++)
+                         {
+                             int source = sources[s];
+                             order.clear();
+                             state[source].distance = 0;
+                             state[source].paths = 1;
+                             order.push_back(source);
+
+                             // BFS counting shortest paths; order doubles as the queue
+                             for (size_t head = 0; head < order.size(); head++)
+                             {
+                                 int v = order[head];
+                                 int next = state[v].distance + 1;
+                                 double paths = state[v].paths;
+                                 for (size_t e = dense.offsets[v]; e < dense.offsets[v + 1]; e++)
+                                 {
+                                     PathState &w = state[dense.targets[e]];
+                                     if (w.distance < 0)
+                                     {
+                                         w.distance = next;
+                                         order.push_back(dense.targets[e]);
+                                     }
+                                     if (w.distance == next)
+                                         w.paths += paths;
+                                 }
+                             }
+
+                             // Dependencies in reverse BFS order; predecessors are the
+                             // neighbours one level closer to the source
+                             for (size_t k = order.size(); k-- > 1;)
+                             {
+                                 int w = order[k];
+                                 int previous = state[w].distance - 1;
+                                 double coefficient = (1.0 + state[w].dependency) / state[w].paths;
+                                 for (size_t e = dense.offsets[w]; e < dense.offsets[w + 1]; e++)
+                                 {
+                                     PathState &v = state[dense.targets[e]];
+                                     if (v.distance == previous)
+                                         v.dependency += v.paths * coefficient;
+                                 }
+                                 local[w] += state[w].dependency;
+                             }
+
+                             for (int v : order)
+                             {
+                                 state[v] = PathState();
+                             }
+                         }
+
+                         lock_guard<mutex> lock(mergeMutex);
+                         for (size_t i = 0; i < n; i++)
+                         {
+                             centrality[i] += local[i];
+                         }
+                     });
+
+    // Every unordered pair is counted from both ends when all sources are used
+    double scale = (double)n / samples / 2.0;
+    for (double &value : centrality)
+    {
+        value *= scale;
+    }
+    return toVertexOrder(graph, dense, centrality);
+}
+
+vector<double> GraphMetrics::degreeCentrality(const Graph &graph)
+{
+    size_t n = graph.getVertexCount();
+    vector<double> centrality(n, 0.0);
+    int users = graph.getUserCount();
+    if (users < 2)
+        return centrality;
+
+    for (size_t vertex = 0; vertex < n; vertex++)
+    {
+        if (graph.isRemoved(vertex))
+            continue;
+        size_t degree = 0;
+        for (int neighbor : graph.getNeighbors(vertex))
+        {
+            if (!graph.isRemoved(neighbor))
+                degree++;
+        }
+        centrality[vertex] = (double)degree / (users - 1);
+    }
+    return centrality;
+}
+
+double GraphMetrics::closeness(const Graph &graph, int vertex)
+{
+    int users = graph.getUserCount();
+    if (users < 2 || graph.isRemoved(vertex))
+        return 0;
+
+    vector<int> distance(graph.getVertexCount(), -1);
+    vector<int> order;
+    distance[vertex] = 0;
+    order.push_back(vertex);
+    double total = 0;
+    for (size_t head = 0; head < order.size(); head++)
+    {
+        int v = order[head];
+        total += distance[v];
+        for (int w : graph.getNeighbors(v))
+        {
+            if (distance[w] < 0 && !graph.isRemoved(w))
+            {
+                distance[w] = distance[v] + 1;
+                order.push_back(w);
+            }
+        }
+    }
+
+    double reached = order.size() - 1;
+    if (total == 0)
+        return 0;
+    return (reached / (users - 1)) * (reached / total);
+}
+
+vector<pair<int, double>> GraphMetrics::topK(const Graph &graph, const vector<double> &scores, size_t k)
+{
+    vector<pair<int, double>> ranked;
+    for (size_t vertex = 0; vertex < scores.size(); vertex++)
+    {
+        if (!graph.isRemoved(vertex))
+            ranked.push_back({vertex, scores[vertex]});
+    }
+
+    k = min(k, ranked.size());
+    auto better = [](const pair<int, double> &a, const pair<int, double> &b)
+    { return a.second != b.second ? a.second > b.second : a.first < b.first; };
+    partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(), better);
+    ranked.resize(k);
+    return ranked;
+}
+
+vector<int> GraphMetrics::coreNumbers(const Graph &graph)
+{
+    DenseGraph dense = densify(graph);
+    size_t n = dense.size();
+
+    // Vertices sorted by current degree; bucketStart[d] is where degree d begins.
+    // Lowering a vertex's degree swaps it to the front of its bucket, then moves the
+    // bucket boundary past it.
+    size_t maxDegree = 0;
+    vector<int> degree(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        degree[i] = dense.degree(i);
+        maxDegree = max<size_t>(maxDegree, degree[i]);
+    }
+
+    vector<size_t> bucketStart(maxDegree + 2, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        bucketStart[degree[i] + 1]++;
+    }
+    partial_sum(bucketStart.begin(), bucketStart.end(), bucketStart.begin());
+
+    vector<int> sorted(n);
+    vector<size_t> position(n);
+    vector<size_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < n; i++)
+    {
+        position[i] = fill[degree[i]]++;
+        sorted[position[i]] = i;
+    }
+
+    for (size_t p = 0; p < n; p++)
+    {
+        int v = sorted[p];
+        for (size_t e = dense.offsets[v]; e < dense.offsets[v + 1]; e++)
+        {
+            int u = dense.targets[e];
+            if (degree[u] > degree[v])
+            {
+                size_t first = bucketStart[degree[u]];
+                int w = sorted[first];
+                if (w != u)
+                {
+                    swap(sorted[first], sorted[position[u]]);
+                    position[w] = position[u];
+                    position[u] = first;
+                }
+                bucketStart[degree[u]]++;
+                degree[u]--;
+            }
+        }
+    }
+
+    vector<int> cores(graph.getVertexCount(), -1);
+    for (size_t i = 0; i < n; i++)
+    {
+        cores[dense.vertexOf[i]] = degree[i];
+    }
+    return cores;
+}
+
+vector<int> GraphMetrics::coreNumbersParallel(const Graph &graph)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    DenseGraph dense = densify(graph);
+    size_t n = dense.size();
+
+    unique_ptr<atomic<int>[]> degree(new atomic<int>[n]);
+    vector<int> core(n, -1);
+    vector<int> remaining(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        degree[i].store(dense.degree(i), memory_order_relaxed);
+        remaining[i] = i;
+    }
+
+    for (int k = 0; !remaining.empty(); k++)
+    {
+        // Remaining degrees are all >= k here, so the round starts from those equal to it
+        vector<int> frontier;
+        for (int v : remaining)
+        {
+            if (degree[v].load(memory_order_relaxed) <= k)
+                frontier.push_back(v);
+        }
+
+        while (!frontier.empty())
+        {
+            for (int v : frontier)
+            {
+                core[v] = k;
+            }
+
+            // A neighbour joins the next frontier when its degree drops from k + 1 to k,
+            // which happens exactly once. Decrements below k are undone, so remaining
+            // degrees never fall under the level being peeled.
+            size_t grain = grainFor(frontier.size());
+            vector<vector<int>> next((frontier.size() + grain - 1) / grain);
+            pool.parallelFor(0, frontier.size(), grain, [&](size_t begin, size_t end)
+                             {
+                                 vector<int> &found = next[begin / grain];
+                                 for (size_t f = begin; f < end; f++)
+                                 {
+                                     int v = frontier[f];
+                                     for (size_t e = dense.offsets[v]; e < dense.offsets[v + 1]; e++)
+                                     {
+                                         int u = dense.targets[e];
+                                         if (core[u] >= 0)
+                                             continue;
+                                         int before = degree[u].fetch_sub(1, memory_order_relaxed);
+                                         if (before == k + 1)
+                                             found.push_back(u);
+                                         else if (before <= k)
+                                             degree[u].fetch_add(1, memory_order_relaxed);
+                                     }
+                                 } });
+
+            frontier.clear();
+            for (const vector<int> &found : next)
+            {
+                frontier.insert(frontier.end(), found.begin(), found.end());
+            }
+        }
+
+        remaining.erase(remove_if(remaining.begin(), remaining.end(), [&core](int v)
+                                  { return core[v] >= 0; }),
+                        remaining.end());
+    }
+
+    vector<int> cores(graph.getVertexCount(), -1);
+    for (size_t i = 0; i < n; i++)
+    {
+        cores[dense.vertexOf[i]] = core[i];
+    }
+    return cores;
+}
+
+Graph GraphMetrics::kCore(const Graph &graph, const vector<int> &cores, int k)
+{
+    vector<int> vertices;
+    for (int vertex = 0; vertex < graph.getVertexCount(); vertex++)
+    {
+        if (cores[vertex] >= k)
+            vertices.push_back(vertex);
+    }
+    return graph.inducedSubgraph(vertices);
+}
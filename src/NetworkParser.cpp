@@ -3,12 +3,27 @@
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <utility>
 
 using namespace std;
 
+bool NetworkParser::verbose = true;
+
+void NetworkParser::setVerbose(bool enabled)
+{
+    verbose = enabled;
+}
+
+ostream &NetworkParser::progress()
+{
+    // Without a buffer every write is discarded
+    static ostream discard(nullptr);
+    return verbose ? cout : discard;
+}
+
 string NetworkParser::readFile(const string &filename)
 {
-    cout << "Attempting to read file: " << filename << endl;
+    progress() << "Attempting to read file: " << filename << endl;
     ifstream file(filename);
     if (!file.is_open())
     {
@@ -19,7 +34,7 @@ string NetworkParser::readFile(const string &filename)
     stringstream buffer;
     buffer << file.rdbuf();
     string content = buffer.str();
-    cout << "Successfully read " << content.length() << " bytes" << endl;
+    progress() << "Successfully read " << content.length() << " bytes" << endl;
     return content;
 }
 
@@ -117,9 +132,9 @@ int NetworkParser::parseNumber(const string &jsonStr, size_t &pos)
     return stoi(jsonStr.substr(start, pos - start));
 }
 
-void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&user)
+User NetworkParser::parseUserData(const string &jsonStr, size_t &pos, UserStore &users)
 {
-    cout << "Debug: Starting to parse user data at position " << pos << "\n";
+    progress() << "Debug: Starting to parse user data at position " << pos << "\n";
     skipWhitespace(jsonStr, pos);
 
     if (pos >= jsonStr.length() || jsonStr[pos] != '{')
@@ -130,7 +145,7 @@ void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&use
     }
 
     pos++; // Skip {
-    cout << "Debug: Found opening brace for user object\n";
+    progress() << "Debug: Found opening brace for user object\n";
 
     string id, name, location;
     int age = 0;
@@ -139,10 +154,10 @@ void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&use
     while (pos < jsonStr.length() && jsonStr[pos] != '}')
     {
         skipWhitespace(jsonStr, pos);
-        cout << "Debug: Parsing user field at position " << pos << "\n";
+        progress() << "Debug: Parsing user field at position " << pos << "\n";
 
         string key = parseString(jsonStr, pos);
-        cout << "Debug: Found user field: " << key << "\n";
+        progress() << "Debug: Found user field: " << key << "\n";
 
         skipWhitespace(jsonStr, pos);
         if (pos >= jsonStr.length() || jsonStr[pos] != ':')
@@ -155,26 +170,26 @@ void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&use
         if (key == "id")
         {
             id = parseString(jsonStr, pos);
-            cout << "Debug: Parsed user ID: " << id << "\n";
+            progress() << "Debug: Parsed user ID: " << id << "\n";
         }
         else if (key == "name")
         {
             name = parseString(jsonStr, pos);
-            cout << "Debug: Parsed user name: " << name << "\n";
+            progress() << "Debug: Parsed user name: " << name << "\n";
         }
         else if (key == "age")
         {
             age = parseNumber(jsonStr, pos);
-            cout << "Debug: Parsed user age: " << age << "\n";
+            progress() << "Debug: Parsed user age: " << age << "\n";
         }
         else if (key == "location")
         {
             location = parseString(jsonStr, pos);
-            cout << "Debug: Parsed user location: " << location << "\n";
+            progress() << "Debug: Parsed user location: " << location << "\n";
         }
         else if (key == "interests")
         {
-            cout << "Debug: Starting to parse interests array\n";
+            progress() << "Debug: Starting to parse interests array\n";
             skipWhitespace(jsonStr, pos);
             if (pos >= jsonStr.length() || jsonStr[pos] != '[')
             {
@@ -191,7 +206,7 @@ void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&use
                     skipWhitespace(jsonStr, pos);
                     string interest = parseString(jsonStr, pos);
                     interests.push_back(interest);
-                    cout << "Debug: Added interest: " << interest << "\n";
+                    progress() << "Debug: Added interest: " << interest << "\n";
 
                     skipWhitespace(jsonStr, pos);
                     if (jsonStr[pos] == ',')
@@ -204,7 +219,7 @@ void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&use
                 throw runtime_error("Unterminated array");
             }
             pos++; // Skip ]
-            cout << "Debug: Finished parsing interests array with " << interests.size() << " interests\n";
+            progress() << "Debug: Finished parsing interests array with " << interests.size() << " interests\n";
         }
 
         skipWhitespace(jsonStr, pos);
@@ -218,13 +233,14 @@ void NetworkParser::parseUserData(const string &jsonStr, size_t &pos, User *&use
     }
     pos++; // Skip }
 
-    cout << "Debug: Creating user object\n";
-    user = new User(id, name, age, location);
+    progress() << "Debug: Creating user object\n";
+    User user = users.addUser(id, name, age, location);
     for (const auto &interest : interests)
     {
-        user->addInterest(interest);
+        user.addInterest(interest);
     }
-    cout << "Debug: Successfully created user object\n";
+    progress() << "Debug: Successfully created user object\n";
+    return user;
 }
 
 void NetworkParser::parseConnections(const string &jsonStr, size_t &pos, Graph &graph)
@@ -309,11 +325,15 @@ void NetworkParser::parseConnections(const string &jsonStr, size_t &pos, Graph &
     }
 }
 
-bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, vector<User *> &users)
+bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, UserStore &users)
 {
     try
     {
-        cout << "Debug: Starting JSON parsing...\n";
+        progress() << "Debug: Starting JSON parsing...\n";
+        // Parse into a fresh network and move it into place only once the whole file is read,
+        // so a failed load leaves the caller's data untouched and the partial one is freed at once
+        Graph loadedGraph;
+        UserStore loadedUsers;
         string jsonStr = readFile(filename);
         size_t pos = 0;
 
@@ -324,15 +344,15 @@ bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, vector<U
             throw runtime_error("Expected object at start of file");
         }
         pos++; // Skip {
-        cout << "Debug: Found opening brace\n";
+        progress() << "Debug: Found opening brace\n";
 
         while (pos < jsonStr.length() && jsonStr[pos] != '}')
         {
             skipWhitespace(jsonStr, pos);
-            cout << "Debug: Parsing key at position " << pos << "\n";
+            progress() << "Debug: Parsing key at position " << pos << "\n";
 
             string key = parseString(jsonStr, pos);
-            cout << "Debug: Found key: " << key << "\n";
+            progress() << "Debug: Found key: " << key << "\n";
 
             skipWhitespace(jsonStr, pos);
             if (pos >= jsonStr.length() || jsonStr[pos] != ':')
@@ -344,7 +364,7 @@ bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, vector<U
 
             if (key == "users")
             {
-                cout << "Debug: Starting to parse users array\n";
+                progress() << "Debug: Starting to parse users array\n";
                 skipWhitespace(jsonStr, pos);
                 if (jsonStr[pos] != '[')
                 {
@@ -355,15 +375,10 @@ bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, vector<U
 
                 while (pos < jsonStr.length() && jsonStr[pos] != ']')
                 {
-                    cout << "Debug: Parsing user object\n";
-                    User *user = nullptr;
-                    parseUserData(jsonStr, pos, user);
-                    if (user)
-                    {
-                        cout << "Debug: Successfully parsed user: " << user->getName() << "\n";
-                        users.push_back(user);
-                        graph.addUser(user->getUserId());
-                    }
+                    progress() << "Debug: Parsing user object\n";
+                    User user = parseUserData(jsonStr, pos, loadedUsers);
+                    progress() << "Debug: Successfully parsed user: " << user.getName() << "\n";
+                    loadedGraph.addUser(string(user.getUserId()));
                     skipWhitespace(jsonStr, pos);
                     if (jsonStr[pos] == ',')
                         pos++;
@@ -375,13 +390,13 @@ bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, vector<U
                     throw runtime_error("Unterminated array");
                 }
                 pos++; // Skip ]
-                cout << "Debug: Finished parsing users array\n";
+                progress() << "Debug: Finished parsing users array\n";
             }
             else if (key == "connections")
             {
-                cout << "Debug: Starting to parse connections\n";
-                parseConnections(jsonStr, pos, graph);
-                cout << "Debug: Finished parsing connections\n";
+                progress() << "Debug: Starting to parse connections\n";
+                parseConnections(jsonStr, pos, loadedGraph);
+                progress() << "Debug: Finished parsing connections\n";
             }
 
             skipWhitespace(jsonStr, pos);
@@ -395,23 +410,19 @@ bool NetworkParser::parseJSONFile(const string &filename, Graph &graph, vector<U
             throw runtime_error("Unterminated object");
         }
 
-        cout << "Debug: JSON parsing completed successfully\n";
+        graph = move(loadedGraph);
+        users = move(loadedUsers);
+        progress() << "Debug: JSON parsing completed successfully\n";
         return true;
     }
     catch (const exception &e)
     {
         cerr << "Debug: Exception caught: " << e.what() << "\n";
-        // Clean up any allocated users in case of error
-        for (User *user : users)
-        {
-            delete user;
-        }
-        users.clear();
         return false;
     }
 }
 
-bool NetworkParser::parseCSVFile(const string &filename, Graph &graph, vector<User *> &users)
+bool NetworkParser::parseCSVFile(const string &filename, Graph &graph, UserStore &users)
 {
     ifstream file(filename);
     if (!file.is_open())
@@ -421,6 +432,8 @@ bool NetworkParser::parseCSVFile(const string &filename, Graph &graph, vector<Us
 
     try
     {
+        Graph loadedGraph;
+        UserStore loadedUsers;
         string line;
         bool isFirstLine = true;
         vector<string> headers;
@@ -450,33 +463,28 @@ bool NetworkParser::parseCSVFile(const string &filename, Graph &graph, vector<Us
 
             if (values.size() >= 4)
             { // Assuming minimum required fields: id, name, age, location
-                User *user = new User(values[0], values[1], stoi(values[2]), values[3]);
-                users.push_back(user);
-                graph.addUser(user->getUserId());
+                User user = loadedUsers.addUser(values[0], values[1], stoi(values[2]), values[3]);
+                loadedGraph.addUser(string(user.getUserId()));
 
                 // Add any additional fields as profile data
                 for (size_t i = 4; i < values.size() && i < headers.size(); ++i)
                 {
-                    user->addProfileData(headers[i], values[i]);
+                    user.addProfileData(headers[i], values[i]);
                 }
             }
         }
 
+        graph = move(loadedGraph);
+        users = move(loadedUsers);
         return true;
     }
     catch (const exception &e)
     {
-        // Clean up any allocated users in case of error
-        for (User *user : users)
-        {
-            delete user;
-        }
-        users.clear();
         return false;
     }
 }
 
-bool NetworkParser::exportToJSON(const string &filename, const Graph &graph, const vector<User *> &users)
+bool NetworkParser::exportToJSON(const string &filename, const Graph &graph, const UserStore &users)
 {
     try
     {
@@ -490,15 +498,15 @@ bool NetworkParser::exportToJSON(const string &filename, const Graph &graph, con
 
         for (size_t i = 0; i < users.size(); ++i)
         {
-            const User *user = users[i];
+            const ConstUser user = users[i];
             file << "    {\n";
-            file << "      \"id\": \"" << user->getUserId() << "\",\n";
-            file << "      \"name\": \"" << user->getName() << "\",\n";
-            file << "      \"age\": " << user->getAge() << ",\n";
-            file << "      \"location\": \"" << user->getLocation() << "\",\n";
+            file << "      \"id\": \"" << user.getUserId() << "\",\n";
+            file << "      \"name\": \"" << user.getName() << "\",\n";
+            file << "      \"age\": " << user.getAge() << ",\n";
+            file << "      \"location\": \"" << user.getLocation() << "\",\n";
             file << "      \"interests\": [\n";
 
-            const auto &interests = user->getInterests();
+            InterestRange interests = user.getInterests();
             for (size_t j = 0; j < interests.size(); ++j)
             {
                 file << "        \"" << interests[j] << "\"";
@@ -517,14 +525,18 @@ bool NetworkParser::exportToJSON(const string &filename, const Graph &graph, con
         file << "  ],\n  \"connections\": [\n";
 
         // Export connections
-        const auto &adjList = graph.getAdjacencyList();
         bool firstConnection = true;
 
-        for (const auto &[userId, connections] : adjList)
+        for (int vertex = 0; vertex < graph.getVertexCount(); vertex++)
         {
-            for (const auto &connectedId : connections)
+            if (graph.isRemoved(vertex))
+                continue;
+
+            const string &userId = graph.getUserId(vertex);
+            for (int neighbor : graph.getNeighbors(vertex))
             {
-                if (userId < connectedId)
+                const string &connectedId = graph.getUserId(neighbor);
+                if (!graph.isRemoved(neighbor) && userId < connectedId)
                 { // Only export each connection once
                     if (!firstConnection)
                         file << ",\n";
@@ -546,7 +558,7 @@ bool NetworkParser::exportToJSON(const string &filename, const Graph &graph, con
     }
 }
 
-bool NetworkParser::exportToCSV(const string &filename, const Graph &graph, const vector<User *> &users)
+bool NetworkParser::exportToCSV(const string &filename, const Graph &graph, const UserStore &users)
 {
     try
     {
@@ -560,15 +572,15 @@ bool NetworkParser::exportToCSV(const string &filename, const Graph &graph, cons
         file << "id,name,age,location,interests\n";
 
         // Write user data
-        for (const User *user : users)
+        for (const ConstUser user : users)
         {
-            file << user->getUserId() << ",";
-            file << user->getName() << ",";
-            file << user->getAge() << ",";
-            file << user->getLocation() << ",";
+            file << user.getUserId() << ",";
+            file << user.getName() << ",";
+            file << user.getAge() << ",";
+            file << user.getLocation() << ",";
 
             // Write interests as semicolon-separated list
-            const auto &interests = user->getInterests();
+            InterestRange interests = user.getInterests();
             for (size_t i = 0; i < interests.size(); ++i)
             {
                 file << interests[i];
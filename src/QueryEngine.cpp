@@ -0,0 +1,203 @@
+#include "../include/QueryEngine.hpp"
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+QueryEngine::QueryEngine(const UserStore &indexedUsers)
+    : users(indexedUsers), indexedCount(indexedUsers.size())
+{
+    const vector<int> &ages = users.getAges();
+    const vector<unsigned int> &locationIds = users.getLocationIds();
+
+    locationBitmaps.resize(users.getLocationDictionary().size());
+    interestBitmaps.resize(users.getInterestDictionary().size());
+
+    ageIndex.reserve(indexedCount);
+    for (unsigned int row = 0; row < indexedCount; row++)
+    {
+        ageIndex.push_back({ages[row], row});
+        locationBitmaps[locationIds[row]].add(row);
+
+        InterestRange interests = users.getInterests(row);
+        for (const unsigned int *id = interests.idsBegin(); id != interests.idsEnd(); ++id)
+        {
+            interestBitmaps[*id].add(row);
+        }
+    }
+    sort(ageIndex.begin(), ageIndex.end());
+
+    profileKeys = users.getProfileKeys();
+    sort(profileKeys.begin(), profileKeys.end());
+    for (const string &key : profileKeys)
+    {
+        vector<unsigned int> rows;
+        for (const auto &entry : *users.findProfileColumn(key))
+        {
+            if (entry.first < indexedCount)
+                rows.push_back(entry.first);
+        }
+        sort(rows.begin(), rows.end());
+
+        profileKeyBitmaps.emplace_back();
+        for (unsigned int row : rows)
+        {
+            profileKeyBitmaps.back().add(row);
+        }
+    }
+}
+
+bool QueryEngine::plan(const UserQuery &query, vector<Predicate> &predicates) const
+{
+    if (query.minAge > query.maxAge)
+        return false;
+
+    if (query.minAge != numeric_limits<int>::min() || query.maxAge != numeric_limits<int>::max())
+    {
+        auto first = lower_bound(ageIndex.begin(), ageIndex.end(), make_pair(query.minAge, 0u));
+        auto last = upper_bound(ageIndex.begin(), ageIndex.end(), make_pair(query.maxAge, numeric_limits<unsigned int>::max()));
+        predicates.push_back({PredicateType::AGE, 0, (size_t)(last - first),
+                              "age " + to_string(query.minAge) + ".." + to_string(query.maxAge)});
+    }
+
+    if (!query.location.empty())
+    {
+        unsigned int id = users.getLocationDictionary().find(query.location);
+        if (id == StringDictionary::NOT_FOUND || id >= locationBitmaps.size())
+            return false;
+        predicates.push_back({PredicateType::LOCATION, id, locationBitmaps[id].cardinality(), "location = " + query.location});
+    }
+
+    for (const string &interest : query.interests)
+    {
+        unsigned int id = users.getInterestDictionary().find(interest);
+        if (id == StringDictionary::NOT_FOUND || id >= interestBitmaps.size())
+            return false;
+        predicates.push_back({PredicateType::INTEREST, id, interestBitmaps[id].cardinality(), "interest = " + interest});
+    }
+
+    for (const string &key : query.profileKeys)
+    {
+        auto it = lower_bound(profileKeys.begin(), profileKeys.end(), key);
+        if (it == profileKeys.end() || *it != key)
+            return false;
+        unsigned int position = it - profileKeys.begin();
+        predicates.push_back({PredicateType::PROFILE_KEY, position, profileKeyBitmaps[position].cardinality(), "has " + key});
+    }
+
+    stable_sort(predicates.begin(), predicates.end(), [](const Predicate &a, const Predicate &b)
+                { return a.estimate < b.estimate; });
+    return predicates.empty() || predicates.front().estimate > 0;
+}
+
+const RoaringBitmap &QueryEngine::bitmapOf(const Predicate &predicate) const
+{
+    if (predicate.type == PredicateType::LOCATION)
+        return locationBitmaps[predicate.id];
+    if (predicate.type == PredicateType::INTEREST)
+        return interestBitmaps[predicate.id];
+    return profileKeyBitmaps[predicate.id];
+}
+
+RoaringBitmap QueryEngine::ageBitmap(const UserQuery &query) const
+{
+    auto first = lower_bound(ageIndex.begin(), ageIndex.end(), make_pair(query.minAge, 0u));
+    auto last = upper_bound(ageIndex.begin(), ageIndex.end(), make_pair(query.maxAge, numeric_limits<unsigned int>::max()));
+    vector<unsigned int> rows;
+    rows.reserve(last - first);
+    for (auto it = first; it != last; ++it)
+    {
+        rows.push_back(it->second);
+    }
+    sort(rows.begin(), rows.end());
+
+    RoaringBitmap bitmap;
+    for (unsigned int row : rows)
+    {
+        bitmap.add(row);
+    }
+    return bitmap;
+}
+
+vector<ConstUser> QueryEngine::search(const UserQuery &query) const
+{
+    vector<ConstUser> results;
+    vector<Predicate> predicates;
+    if (!plan(query, predicates))
+        return results;
+
+    vector<unsigned int> rows;
+    if (predicates.empty())
+    {
+        for (unsigned int row = 0; row < indexedCount; row++)
+        {
+            rows.push_back(row);
+        }
+    }
+    else
+    {
+        // Intersect in selectivity order, working on the index's own bitmap until the
+        // first intersection produces a smaller one
+        RoaringBitmap intersection;
+        bool ageFirst = predicates.front().type == PredicateType::AGE;
+        if (ageFirst)
+            intersection = ageBitmap(query);
+        const RoaringBitmap *candidates = ageFirst ? &intersection : &bitmapOf(predicates.front());
+        bool filterAge = false;
+        for (size_t p = 1; p < predicates.size() && !candidates->empty(); p++)
+        {
+            if (predicates[p].type == PredicateType::AGE)
+            {
+                filterAge = true;
+                continue;
+            }
+            intersection = candidates->intersect(bitmapOf(predicates[p]));
+            candidates = &intersection;
+        }
+        rows = candidates->toVector();
+
+        if (filterAge)
+        {
+            const vector<int> &ages = users.getAges();
+            rows.erase(remove_if(rows.begin(), rows.end(), [&](unsigned int row)
+                                 { return ages[row] < query.minAge || ages[row] > query.maxAge; }),
+                       rows.end());
+        }
+    }
+
+    results.reserve(rows.size());
+    for (unsigned int row : rows)
+    {
+        results.push_back(users[row]);
+    }
+    return results;
+}
+
+string QueryEngine::explain(const UserQuery &query) const
+{
+    vector<Predicate> predicates;
+    if (!plan(query, predicates))
+        return "No user can match this query\n";
+    if (predicates.empty())
+        return "Scan all " + to_string(indexedCount) + " users\n";
+
+    // Same order as search: the age range, when not first, is checked after the intersections
+    stable_partition(predicates.begin() + 1, predicates.end(), [](const Predicate &predicate)
+                     { return predicate.type != PredicateType::AGE; });
+    stringstream ss;
+    for (size_t i = 0; i < predicates.size(); i++)
+    {
+        string step = "Intersect ";
+        if (i == 0)
+            step = "Index lookup ";
+        else if (predicates[i].type == PredicateType::AGE)
+            step = "Filter ";
+        ss << (i + 1) << ". " << step << predicates[i].description << " (" << predicates[i].estimate << " users)\n";
+    }
+    return ss.str();
+}
+
+size_t QueryEngine::getIndexedCount() const
+{
+    return indexedCount;
+}
@@ -0,0 +1,467 @@
+#include "../include/QueryServer.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+atomic<bool> QueryServer::stopRequested(false);
+
+// How often the poll loop wakes up to check for a stop request
+static const int POLL_INTERVAL_MS = 200;
+// How long a stopping server keeps sending answers already produced to slow readers
+static const int STOP_FLUSH_MS = 1000;
+
+// Cursor over a request line. Only what requests need is supported: one flat object
+// whose values are strings, numbers or arrays of those.
+struct RequestParser
+{
+    const string &text;
+    size_t pos = 0;
+
+    explicit RequestParser(const string &line) : text(line) {}
+
+    void skipWhitespace()
+    {
+        while (pos < text.length() && isspace((unsigned char)text[pos]))
+            pos++;
+    }
+
+    bool consume(char c)
+    {
+        skipWhitespace();
+        if (pos < text.length() && text[pos] == c)
+        {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    static void appendUtf8(string &out, unsigned int code)
+    {
+        if (code < 0x80)
+        {
+            out += (char)code;
+        }
+        else if (code < 0x800)
+        {
+            out += (char)(0xC0 | code >> 6);
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += (char)(0xE0 | code >> 12);
+            out += (char)(0x80 | (code >> 6 & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+
+    string parseString()
+    {
+        if (!consume('"'))
+            throw runtime_error("expected a string");
+
+        string result;
+        while (pos < text.length() && text[pos] != '"')
+        {
+            char c = text[pos++];
+            if (c != '\\')
+            {
+                result += c;
+                continue;
+            }
+            if (pos >= text.length())
+                break;
+
+            char escaped = text[pos++];
+            switch (escaped)
+            {
+            case 'n':
+                result += '\n';
+                break;
+            case 't':
+                result += '\t';
+                break;
+            case 'r':
+                result += '\r';
+                break;
+            case 'b':
+                result += '\b';
+                break;
+            case 'f':
+                result += '\f';
+                break;
+            case 'u':
+                if (pos + 4 > text.length())
+                    throw runtime_error("bad unicode escape");
+                appendUtf8(result, stoul(text.substr(pos, 4), nullptr, 16));
+                pos += 4;
+                break;
+            default:
+                result += escaped;
+            }
+        }
+        if (!consume('"'))
+            throw runtime_error("unterminated string");
+        return result;
+    }
+
+    // Strings are returned unquoted, numbers as written
+    string parseScalar()
+    {
+        skipWhitespace();
+        if (pos < text.length() && text[pos] == '"')
+            return parseString();
+
+        size_t start = pos;
+        while (pos < text.length() && (isdigit((unsigned char)text[pos]) || text[pos] == '-' || text[pos] == '.'))
+            pos++;
+        if (start == pos)
+            throw runtime_error("expected a string or number");
+        return text.substr(start, pos - start);
+    }
+
+    void parseRequest(string &command, vector<string> &args)
+    {
+        if (!consume('{'))
+            throw runtime_error("expected a JSON object");
+
+        bool first = true;
+        while (!consume('}'))
+        {
+            if (!first && !consume(','))
+                throw runtime_error("expected ',' or '}'");
+            first = false;
+
+            string key = parseString();
+            if (!consume(':'))
+                throw runtime_error("expected ':'");
+
+            if (consume('['))
+            {
+                vector<string> values;
+                bool firstValue = true;
+                while (!consume(']'))
+                {
+                    if (!firstValue && !consume(','))
+                        throw runtime_error("expected ',' or ']'");
+                    firstValue = false;
+                    values.push_back(parseScalar());
+                }
+                if (key == "args")
+                    args = values;
+            }
+            else
+            {
+                string value = parseScalar();
+                if (key == "command")
+                    command = value;
+            }
+        }
+
+        skipWhitespace();
+        if (pos != text.length())
+            throw runtime_error("trailing characters after the request");
+    }
+};
+
+QueryServer::QueryServer(CommandRunner &commandRunner, const string &path, size_t clientThreads)
+    : runner(commandRunner), socketPath(path), clientPool(clientThreads) {}
+
+void QueryServer::requestStop()
+{
+    stopRequested = true;
+}
+
+string QueryServer::handleRequest(const string &line) const
+{
+    string command;
+    vector<string> args;
+    try
+    {
+        RequestParser(line).parseRequest(command, args);
+    }
+    catch (const exception &e)
+    {
+        return CommandRunner::errorResult(command, string("invalid request: ") + e.what());
+    }
+
+    if (command.empty())
+        return CommandRunner::errorResult(command, "missing command");
+    if (!CommandRunner::isReadOnly(command) && !CommandRunner::isMutation(command))
+        return CommandRunner::errorResult(command, "command not available from the server");
+
+    vector<string> words = {command};
+    words.insert(words.end(), args.begin(), args.end());
+    return runner.run(words);
+}
+
+static void setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Reads whatever the client has sent. Returns false when the peer has closed its side.
+static bool receiveAvailable(int fd, string &input, bool &failed)
+{
+    char chunk[4096];
+    while (true)
+    {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n > 0)
+        {
+            input.append(chunk, n);
+            if (input.length() > QueryServer::MAX_REQUEST_BYTES)
+                return true;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (n < 0)
+            failed = true;
+        return false;
+    }
+}
+
+// Sends as much pending output as the socket takes without blocking
+static void sendAvailable(int fd, string &output, bool &failed)
+{
+    size_t sent = 0;
+    while (sent < output.length())
+    {
+        ssize_t n = send(fd, output.data() + sent, output.length() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n <= 0)
+        {
+            failed = true;
+            break;
+        }
+        sent += n;
+    }
+    output.erase(0, sent);
+}
+
+void QueryServer::dispatch(int clientFd, Client &client)
+{
+    if (client.busy || client.failed)
+        return;
+
+    size_t newline;
+    while ((newline = client.input.find('\n')) != string::npos)
+    {
+        string line = client.input.substr(0, newline);
+        client.input.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.find_first_not_of(" \t") == string::npos)
+            continue;
+
+        client.busy = true;
+        clientPool.submit([this, clientFd, line]
+                          {
+                              string response = handleRequest(line) + "\n";
+                              // The pipe is written under the lock, so once the loop has
+                              // seen every job report it may close the pipe
+                              lock_guard<mutex> lock(completedMutex);
+                              completed.push_back({clientFd, move(response)});
+                              char wake = 0;
+                              ssize_t written = write(wakePipe[1], &wake, 1);
+                              (void)written; // A full pipe already wakes the loop
+                              jobFinished.notify_one();
+                          });
+        return;
+    }
+
+    if (!client.inputClosed && client.input.length() > MAX_REQUEST_BYTES)
+    {
+        client.output += CommandRunner::errorResult("", "request too long") + "\n";
+        client.input.clear();
+        client.inputClosed = true;
+    }
+}
+
+void QueryServer::run()
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.length() >= sizeof(address.sun_path))
+        throw runtime_error("invalid socket path: " + socketPath);
+    strcpy(address.sun_path, socketPath.c_str());
+
+    // Replace a socket left behind by an earlier run, but never another kind of file
+    struct stat existing;
+    if (lstat(socketPath.c_str(), &existing) == 0)
+    {
+        if (!S_ISSOCK(existing.st_mode))
+            throw runtime_error(socketPath + " exists and is not a socket");
+        unlink(socketPath.c_str());
+    }
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        throw runtime_error(string("socket: ") + strerror(errno));
+    if (bind(listenFd, (sockaddr *)&address, sizeof(address)) < 0 || listen(listenFd, 64) < 0 ||
+        pipe(wakePipe) < 0)
+    {
+        string error = strerror(errno);
+        close(listenFd);
+        throw runtime_error("could not listen on " + socketPath + ": " + error);
+    }
+    setNonBlocking(listenFd);
+    setNonBlocking(wakePipe[0]);
+    setNonBlocking(wakePipe[1]);
+
+    // Keyed by socket. A socket is closed only while no request of its client is on the
+    // pool, so a finished response can never reach a new client that reuses the number.
+    map<int, Client> clients;
+    size_t running = 0;
+    string pollError;
+    chrono::steady_clock::time_point flushDeadline;
+    bool stopping = false;
+    stopRequested = false;
+    // After a stop request no new work is started. Requests already on the pool are
+    // waited for, and answers not yet sent get up to STOP_FLUSH_MS to go out.
+    while (true)
+    {
+        if (stopRequested && !stopping)
+        {
+            stopping = true;
+            flushDeadline = chrono::steady_clock::now() + chrono::milliseconds(STOP_FLUSH_MS);
+        }
+        if (stopping && running == 0)
+        {
+            bool unsent = false;
+            for (const auto &[fd, client] : clients)
+            {
+                unsent |= !client.output.empty() && !client.failed;
+            }
+            if (!unsent || chrono::steady_clock::now() >= flushDeadline)
+                break;
+        }
+
+        vector<pollfd> polled = {{wakePipe[0], POLLIN, 0}};
+        if (!stopping)
+            polled.push_back({listenFd, POLLIN, 0});
+        for (const auto &[fd, client] : clients)
+        {
+            short events = 0;
+            if (!client.inputClosed && !client.failed && client.input.length() <= MAX_REQUEST_BYTES)
+                events |= POLLIN;
+            if (!client.output.empty() && !client.failed)
+                events |= POLLOUT;
+            // A client with nothing to wait for is left out, or its hangup would be
+            // reported on every poll while its last request runs
+            if (events != 0)
+                polled.push_back({fd, events, 0});
+        }
+
+        int ready = poll(polled.data(), polled.size(), POLL_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR)
+        {
+            pollError = strerror(errno);
+            break;
+        }
+
+        char drained[64];
+        while (read(wakePipe[0], drained, sizeof(drained)) > 0)
+        {
+        }
+        vector<pair<int, string>> finished;
+        {
+            lock_guard<mutex> lock(completedMutex);
+            finished.swap(completed);
+        }
+        for (auto &[fd, response] : finished)
+        {
+            Client &client = clients[fd];
+            client.busy = false;
+            client.output += response;
+            running--;
+        }
+
+        for (const pollfd &entry : polled)
+        {
+            auto it = clients.find(entry.fd);
+            if (it == clients.end() || entry.revents == 0)
+                continue;
+            Client &client = it->second;
+            if (entry.revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                if (!receiveAvailable(entry.fd, client.input, client.failed))
+                    client.inputClosed = true;
+            }
+            if (entry.revents & POLLOUT)
+                sendAvailable(entry.fd, client.output, client.failed);
+        }
+
+        if (!stopping)
+        {
+            int clientFd;
+            while ((clientFd = accept(listenFd, nullptr, nullptr)) >= 0)
+            {
+                setNonBlocking(clientFd);
+                clients[clientFd];
+            }
+        }
+
+        for (auto it = clients.begin(); it != clients.end();)
+        {
+            int fd = it->first;
+            Client &client = it->second;
+            if (!stopping && !client.busy)
+            {
+                dispatch(fd, client);
+                if (client.busy)
+                    running++;
+            }
+            if (!client.output.empty() && !client.failed)
+                sendAvailable(fd, client.output, client.failed);
+
+            // Closed once idle, and after a client's EOF only when every request it sent
+            // has been answered. A stopping server closes every client whose answers are out.
+            bool done = client.failed || (client.output.empty() &&
+                                          (stopping || (client.inputClosed && client.input.find('\n') == string::npos)));
+            if (!client.busy && done)
+            {
+                close(fd);
+                it = clients.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // Only reached early on a poll failure: jobs still on the pool report through the
+    // pipe, so it stays open until all of them have
+    {
+        unique_lock<mutex> lock(completedMutex);
+        jobFinished.wait(lock, [&]
+                         { return completed.size() >= running; });
+    }
+    for (const auto &[fd, client] : clients)
+    {
+        close(fd);
+    }
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    wakePipe[0] = wakePipe[1] = -1;
+    close(listenFd);
+    unlink(socketPath.c_str());
+    if (!pollError.empty())
+        throw runtime_error("poll: " + pollError);
+}
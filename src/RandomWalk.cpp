@@ -0,0 +1,188 @@
+#include "../include/RandomWalk.hpp"
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+using namespace std;
+
+// Uniform double in [0, 1) from the top 53 bits of a draw
+static double toUnit(unsigned long long bits)
+{
+    return (bits >> 11) * 0x1.0p-53;
+}
+
+void RandomWalkEngine::buildAlias(double *weights, size_t count, float *probability, int *alias)
+{
+    // Scaled so the average slot holds exactly 1. Every slot below 1 is topped up from one
+    // above, which becomes its alias, until no slot is left on either side.
+    double total = accumulate(weights, weights + count, 0.0);
+    vector<int> slots(count); // Below 1 from the front, at least 1 from the back
+    size_t smallEnd = 0, largeBegin = count;
+    for (size_t i = 0; i < count; i++)
+    {
+        weights[i] *= count / total;
+        probability[i] = 1.0f;
+        alias[i] = i;
+        if (weights[i] < 1.0)
+            slots[smallEnd++] = i;
+        else
+            slots[--largeBegin] = i;
+    }
+
+    while (smallEnd > 0 && largeBegin < count)
+    {
+        int small = slots[--smallEnd];
+        int large = slots[largeBegin];
+        probability[small] = weights[small];
+        alias[small] = large;
+        weights[large] -= 1.0 - weights[small];
+        if (weights[large] < 1.0)
+        {
+            largeBegin++;
+            slots[smallEnd++] = large;
+        }
+    }
+    // Whatever is left holds 1 up to rounding and keeps probability 1
+}
+
+RandomWalkEngine::RandomWalkEngine(const Graph &graph, const function<double(int, int)> &weight)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    size_t n = graph.getVertexCount();
+
+    offsets.assign(n + 1, 0);
+    for (size_t vertex = 0; vertex < n; vertex++)
+    {
+        if (graph.isRemoved(vertex))
+            continue;
+        for (int neighbor : graph.getNeighbors(vertex))
+        {
+            if (!graph.isRemoved(neighbor))
+                offsets[vertex + 1]++;
+        }
+    }
+    partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    targets.resize(offsets[n]);
+    if (weight)
+    {
+        probability.resize(offsets[n]);
+        alias.resize(offsets[n]);
+    }
+
+    size_t grain = max<size_t>(64, n / (pool.getThreadCount() * 16 + 1));
+    pool.parallelFor(0, n, grain, [&](size_t begin, size_t end)
+                     {
+                         vector<double> weights;
+                         for (size_t vertex = begin; vertex < end; vertex++)
+                         {
+                             if (graph.isRemoved(vertex))
+                                 continue;
+                             int *out = targets.data() + offsets[vertex];
+                             for (int neighbor : graph.getNeighbors(vertex))
+                             {
+                                 if (!graph.isRemoved(neighbor))
+                                     *out++ = neighbor;
+                             }
+                             if (!weight)
+                                 continue;
+
+                             size_t first = offsets[vertex];
+                             size_t count = offsets[vertex + 1] - first;
+                             weights.resize(count);
+                             for (size_t i = 0; i < count; i++)
+                             {
+                                 weights[i] = weight(vertex, targets[first + i]);
+                             }
+                             buildAlias(weights.data(), count, probability.data() + first, alias.data() + first);
+                         } });
+}
+
+vector<pair<int, double>> RandomWalkEngine::personalizedPageRank(int source, size_t walks, double restart,
+                                                                 unsigned int seed) const
+{
+    vector<pair<int, double>> scores;
+    if (source < 0 || source >= getVertexCount() || walks == 0)
+        return scores;
+    // Visits are counted in hash maps rather than per-vertex arrays, so a query touches
+    // only what its walks reach
+    unordered_map<int, size_t> visits;
+    size_t steps = 0;
+    mutex mergeMutex;
+    ThreadPool::shared().parallelFor(0, walks, WALKS_PER_CHUNK, [&](size_t begin, size_t end)
+                                     {
+                                         seed_seq sequence{seed, (unsigned int)(begin / WALKS_PER_CHUNK)};
+                                         mt19937_64 rng(sequence);
+                                         unordered_map<int, size_t> local;
+                                         size_t localSteps = 0;
+
+                                         for (size_t walk = begin; walk < end; walk++)
+                                         {
+                                             int vertex = source;
+                                             for (size_t length = 1;; length++)
+                                             {
+                                                 local[vertex]++;
+                                                 localSteps++;
+                                                 size_t first = offsets[vertex];
+                                                 size_t degree = offsets[vertex + 1] - first;
+                                                 if (degree == 0 || length == MAX_WALK_LENGTH || toUnit(rng()) < restart)
+                                                     break;
+
+                                                 size_t slot = rng() % degree;
+                                                 if (!alias.empty() && toUnit(rng()) >= probability[first + slot])
+                                                     slot = alias[first + slot];
+                                                 vertex = targets[first + slot];
+                                             }
+                                         }
+
+                                         lock_guard<mutex> lock(mergeMutex);
+                                         for (const auto &entry : local)
+                                         {
+                                             visits[entry.first] += entry.second;
+                                         }
+                                         steps += localSteps; });
+
+    scores.reserve(visits.size());
+    for (const auto &entry : visits)
+    {
+        scores.push_back({entry.first, (double)entry.second / steps});
+    }
+    sort(scores.begin(), scores.end(), [](const pair<int, double> &a, const pair<int, double> &b)
+         { return a.second != b.second ? a.second > b.second : a.first < b.first; });
+    return scores;
+}
+
+vector<pair<int, double>> RandomWalkEngine::recommend(int source, size_t k, size_t walks, double restart,
+                                                      unsigned int seed) const
+{
+    vector<pair<int, double>> scores = personalizedPageRank(source, walks, restart, seed);
+    if (scores.empty())
+        return scores;
+
+    vector<int> friends(targets.begin() + offsets[source], targets.begin() + offsets[source + 1]);
+    sort(friends.begin(), friends.end());
+
+    vector<pair<int, double>> recommendations;
+    for (const auto &score : scores)
+    {
+        if (recommendations.size() == k)
+            break;
+        if (score.first != source && !binary_search(friends.begin(), friends.end(), score.first))
+            recommendations.push_back(score);
+    }
+    return recommendations;
+}
+
+int RandomWalkEngine::getVertexCount() const
+{
+    return offsets.size() - 1;
+}
+
+size_t RandomWalkEngine::getBytesUsed() const
+{
+    return offsets.capacity() * sizeof(size_t) + targets.capacity() * sizeof(int) +
+           probability.capacity() * sizeof(float) + alias.capacity() * sizeof(int);
+}
@@ -0,0 +1,94 @@
+#include "../include/RecommendationCache.hpp"
+#include <algorithm>
+
+using namespace std;
+
+RecommendationCache::RecommendationCache(const RecommendationCache &other)
+{
+    lock_guard<mutex> lock(other.cacheMutex);
+    entries = other.entries;
+    stats = other.stats;
+}
+
+RecommendationCache &RecommendationCache::operator=(const RecommendationCache &other)
+{
+    if (this != &other)
+    {
+        scoped_lock lock(cacheMutex, other.cacheMutex);
+        entries = other.entries;
+        stats = other.stats;
+    }
+    return *this;
+}
+
+bool RecommendationCache::find(int vertex, size_t k, vector<int> &ranking)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    auto it = entries.find(vertex);
+    if (it == entries.end() || !it->second.covers(k))
+    {
+        stats.misses++;
+        return false;
+    }
+
+    const vector<int> &cached = it->second.ranking;
+    ranking.assign(cached.begin(), cached.begin() + min(k, cached.size()));
+    stats.hits++;
+    return true;
+}
+
+void RecommendationCache::store(int vertex, size_t k, vector<int> ranking)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    auto it = entries.find(vertex);
+    if (it != entries.end() && it->second.covers(k))
+        return;
+    entries[vertex] = {move(ranking), k};
+}
+
+void RecommendationCache::invalidate(const vector<int> &vertices)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    for (int vertex : vertices)
+    {
+        stats.invalidations += entries.erase(vertex);
+    }
+}
+
+void RecommendationCache::remap(const vector<int> &newIndex)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    unordered_map<int, Entry> moved;
+    moved.reserve(entries.size());
+    for (auto &[vertex, entry] : entries)
+    {
+        if (newIndex[vertex] < 0)
+            continue;
+        for (int &recommended : entry.ranking)
+        {
+            recommended = newIndex[recommended];
+        }
+        moved[newIndex[vertex]] = move(entry);
+    }
+    entries = move(moved);
+}
+
+void RecommendationCache::clear()
+{
+    lock_guard<mutex> lock(cacheMutex);
+    entries.clear();
+}
+
+bool RecommendationCache::empty() const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    return entries.empty();
+}
+
+RecommendationCacheStats RecommendationCache::getStats() const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    RecommendationCacheStats current = stats;
+    current.entries = entries.size();
+    return current;
+}
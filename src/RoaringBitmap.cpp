@@ -0,0 +1,214 @@
+#include "../include/RoaringBitmap.hpp"
+#include <algorithm>
+
+using namespace std;
+
+RoaringBitmap::Container::Container(unsigned short highBits) : key(highBits), cardinality(0) {}
+
+bool RoaringBitmap::Container::isBitmap() const
+{
+    return !bits.empty();
+}
+
+bool RoaringBitmap::Container::contains(unsigned short low) const
+{
+    if (isBitmap())
+        return bits[low / 64] >> (low % 64) & 1;
+    return binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::add(unsigned short low)
+{
+    if (isBitmap())
+    {
+        unsigned long long mask = 1ULL << (low % 64);
+        if (!(bits[low / 64] & mask))
+        {
+            bits[low / 64] |= mask;
+            cardinality++;
+        }
+        return;
+    }
+
+    // Values usually arrive in ascending order, so try appending first
+    if (array.empty() || array.back() < low)
+    {
+        array.push_back(low);
+    }
+    else
+    {
+        auto it = lower_bound(array.begin(), array.end(), low);
+        if (*it == low)
+            return;
+        array.insert(it, low);
+    }
+    cardinality++;
+
+    if (cardinality > ARRAY_LIMIT)
+    {
+        bits.assign(BITMAP_WORDS, 0);
+        for (unsigned short value : array)
+        {
+            bits[value / 64] |= 1ULL << (value % 64);
+        }
+        array.clear();
+        array.shrink_to_fit();
+    }
+}
+
+void RoaringBitmap::Container::appendTo(vector<unsigned int> &values) const
+{
+    unsigned int high = (unsigned int)key << 16;
+    if (!isBitmap())
+    {
+        for (unsigned short low : array)
+        {
+            values.push_back(high | low);
+        }
+        return;
+    }
+
+    for (unsigned int w = 0; w < BITMAP_WORDS; w++)
+    {
+        unsigned long long word = bits[w];
+        while (word != 0)
+        {
+            values.push_back(high | (w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+RoaringBitmap::Container RoaringBitmap::Container::intersect(const Container &a, const Container &b)
+{
+    Container result(a.key);
+
+    if (a.isBitmap() && b.isBitmap())
+    {
+        vector<unsigned long long> words(BITMAP_WORDS);
+        for (unsigned int w = 0; w < BITMAP_WORDS; w++)
+        {
+            words[w] = a.bits[w] & b.bits[w];
+            result.cardinality += __builtin_popcountll(words[w]);
+        }
+
+        if (result.cardinality > ARRAY_LIMIT)
+        {
+            result.bits = move(words);
+        }
+        else
+        {
+            Container dense(a.key);
+            dense.bits = move(words);
+            vector<unsigned int> values;
+            dense.appendTo(values);
+            for (unsigned int value : values)
+            {
+                result.array.push_back(value & 0xFFFF);
+            }
+        }
+        return result;
+    }
+
+    if (!a.isBitmap() && !b.isBitmap())
+    {
+        set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), back_inserter(result.array));
+    }
+    else
+    {
+        // Probe the bitmap with each value of the array
+        const Container &sparse = a.isBitmap() ? b : a;
+        const Container &dense = a.isBitmap() ? a : b;
+        for (unsigned short low : sparse.array)
+        {
+            if (dense.contains(low))
+                result.array.push_back(low);
+        }
+    }
+    result.cardinality = result.array.size();
+    return result;
+}
+
+RoaringBitmap::RoaringBitmap() {}
+
+const RoaringBitmap::Container *RoaringBitmap::findContainer(unsigned short key) const
+{
+    auto it = lower_bound(containers.begin(), containers.end(), key, [](const Container &c, unsigned short k)
+                          { return c.key < k; });
+    return (it != containers.end() && it->key == key) ? &*it : nullptr;
+}
+
+void RoaringBitmap::add(unsigned int value)
+{
+    unsigned short key = value >> 16;
+    if (containers.empty() || containers.back().key < key)
+    {
+        containers.emplace_back(key);
+        containers.back().add(value & 0xFFFF);
+        return;
+    }
+
+    auto it = lower_bound(containers.begin(), containers.end(), key, [](const Container &c, unsigned short k)
+                          { return c.key < k; });
+    if (it == containers.end() || it->key != key)
+        it = containers.insert(it, Container(key));
+    it->add(value & 0xFFFF);
+}
+
+bool RoaringBitmap::contains(unsigned int value) const
+{
+    const Container *container = findContainer(value >> 16);
+    return container && container->contains(value & 0xFFFF);
+}
+
+size_t RoaringBitmap::cardinality() const
+{
+    size_t total = 0;
+    for (const Container &container : containers)
+    {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+bool RoaringBitmap::empty() const
+{
+    return containers.empty();
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap &other) const
+{
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() && j < other.containers.size())
+    {
+        if (containers[i].key < other.containers[j].key)
+        {
+            i++;
+        }
+        else if (containers[i].key > other.containers[j].key)
+        {
+            j++;
+        }
+        else
+        {
+            Container common = Container::intersect(containers[i], other.containers[j]);
+            if (common.cardinality > 0)
+                result.containers.push_back(move(common));
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+vector<unsigned int> RoaringBitmap::toVector() const
+{
+    vector<unsigned int> values;
+    values.reserve(cardinality());
+    for (const Container &container : containers)
+    {
+        container.appendTo(values);
+    }
+    return values;
+}
@@ -0,0 +1,121 @@
+#include "../include/StringArena.hpp"
+#include <cstring>
+#include <utility>
+
+using namespace std;
+
+StringArena::StringArena() : blockUsed(0), blockCapacity(0), bytesStored(0) {}
+
+StringArena::StringArena(StringArena &&other) noexcept
+    : blocks(move(other.blocks)),
+      blockUsed(exchange(other.blockUsed, 0)),
+      blockCapacity(exchange(other.blockCapacity, 0)),
+      bytesStored(exchange(other.bytesStored, 0))
+{
+    other.blocks.clear();
+}
+
+StringArena &StringArena::operator=(StringArena &&other) noexcept
+{
+    if (this != &other)
+    {
+        blocks = move(other.blocks);
+        other.blocks.clear();
+        blockUsed = exchange(other.blockUsed, 0);
+        blockCapacity = exchange(other.blockCapacity, 0);
+        bytesStored = exchange(other.bytesStored, 0);
+    }
+    return *this;
+}
+
+string_view StringArena::store(string_view value)
+{
+    if (value.empty())
+        return string_view();
+
+    if (value.size() > blockCapacity - blockUsed)
+    {
+        // Oversized values get a block of their own
+        blockCapacity = value.size() > BLOCK_SIZE ? value.size() : BLOCK_SIZE;
+        blocks.emplace_back(new char[blockCapacity]);
+        blockUsed = 0;
+    }
+
+    char *destination = blocks.back().get() + blockUsed;
+    memcpy(destination, value.data(), value.size());
+    blockUsed += value.size();
+    bytesStored += value.size();
+    return string_view(destination, value.size());
+}
+
+void StringArena::clear()
+{
+    blocks.clear();
+    blockUsed = 0;
+    blockCapacity = 0;
+    bytesStored = 0;
+}
+
+size_t StringArena::getBytesStored() const
+{
+    return bytesStored;
+}
+
+size_t StringArena::getBlockCount() const
+{
+    return blocks.size();
+}
+
+StringColumn::StringColumn() {}
+
+StringColumn::StringColumn(const StringColumn &other)
+{
+    *this = other;
+}
+
+StringColumn &StringColumn::operator=(const StringColumn &other)
+{
+    if (this == &other)
+        return *this;
+
+    // The views must point into this column's own arena
+    clear();
+    values.reserve(other.values.size());
+    for (string_view value : other.values)
+    {
+        push_back(value);
+    }
+    return *this;
+}
+
+void StringColumn::push_back(string_view value)
+{
+    values.push_back(arena.store(value));
+}
+
+void StringColumn::set(size_t row, string_view value)
+{
+    values[row] = arena.store(value);
+}
+
+void StringColumn::swapRemove(size_t row)
+{
+    values[row] = values.back();
+    values.pop_back();
+}
+
+void StringColumn::reserve(size_t rows)
+{
+    values.reserve(rows);
+}
+
+void StringColumn::clear()
+{
+    values.clear();
+    arena.clear();
+}
+
+size_t StringColumn::getBytesStored() const
+{
+    return arena.getBytesStored();
+}
@@ -0,0 +1,91 @@
+#include "../include/StringDictionary.hpp"
+
+using namespace std;
+
+StringDictionary::StringDictionary() {}
+
+StringDictionary::StringDictionary(const StringDictionary &other)
+{
+    *this = other;
+}
+
+StringDictionary &StringDictionary::operator=(const StringDictionary &other)
+{
+    if (this == &other)
+        return *this;
+
+    // The views must point into this dictionary's own arena
+    clear();
+    for (string_view value : other.values)
+    {
+        intern(value);
+    }
+    return *this;
+}
+
+unsigned int StringDictionary::intern(string_view value)
+{
+    auto it = ids.find(value);
+    if (it != ids.end())
+        return it->second;
+
+    string_view stored = arena.store(value);
+    ids.emplace(stored, values.size());
+    values.push_back(stored);
+    return values.size() - 1;
+}
+
+unsigned int StringDictionary::find(string_view value) const
+{
+    auto it = ids.find(value);
+    return it == ids.end() ? NOT_FOUND : it->second;
+}
+
+string_view StringDictionary::lookup(unsigned int id) const
+{
+    return values[id];
+}
+
+size_t StringDictionary::size() const
+{
+    return values.size();
+}
+
+void StringDictionary::clear()
+{
+    ids.clear();
+    values.clear();
+    arena.clear();
+}
+
+IdBitset::IdBitset() {}
+
+IdBitset::IdBitset(size_t idCount) : words((idCount + 63) / 64, 0) {}
+
+void IdBitset::insert(unsigned int id)
+{
+    size_t word = id / 64;
+    if (word >= words.size())
+        words.resize(word + 1, 0);
+    words[word] |= 1ULL << (id % 64);
+}
+
+bool IdBitset::empty() const
+{
+    for (unsigned long long word : words)
+    {
+        if (word != 0)
+            return false;
+    }
+    return true;
+}
+
+size_t IdBitset::count() const
+{
+    size_t total = 0;
+    for (unsigned long long word : words)
+    {
+        total += __builtin_popcountll(word);
+    }
+    return total;
+}
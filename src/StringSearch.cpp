@@ -1,67 +1,135 @@
 #include "../include/StringSearch.hpp"
+#include "../include/ThreadPool.hpp"
 #include <algorithm>
+#include <unordered_map>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define STRING_SEARCH_X86_SIMD
+#endif
 
 using namespace std;
 
-// Helper function to convert string to lowercase
-string toLowerCase(const string &str)
+// Case-folds a single character the way tolower does in the "C" locale
+static inline char foldCase(char c)
 {
-    string result = str;
-    transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
 }
 
-vector<int> StringSearch::computeLPSArray(const string &pattern)
+// Upper-case counterpart of a folded character (identity for non-letters)
+static inline char unfoldCase(char c)
 {
-    int m = pattern.length();
-    vector<int> lps(m, 0);
+    return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
 
-    int len = 0;
-    int i = 1;
+// Compares the window starting at text with an already folded pattern
+static inline bool equalsFolded(const char *text, const string &folded)
+{
+    for (size_t j = 0; j < folded.length(); j++)
+    {
+        if (foldCase(text[j]) != folded[j])
+            return false;
+    }
+    return true;
+}
 
-    while (i < m)
+static inline SearchAlgorithm toAlgorithm(bool useKMP)
+{
+    return useKMP ? SearchAlgorithm::KMP : SearchAlgorithm::RABIN_KARP;
+}
+
+// Vector kernels for SearchAlgorithm::SIMD. Each block compares the first pattern byte
+// against text[i..] and the last pattern byte against text[i + m - 1..] (both cases),
+// and only positions where both agree are verified byte by byte. They advance i past
+// the blocks they handled, leaving the tail to the scalar loop, and return the number
+// of matches (stopping at the first one when positions is null).
+#ifdef STRING_SEARCH_X86_SIMD
+static size_t scanBlocksSSE2(string_view text, const string &folded, size_t &i, vector<size_t> *positions)
+{
+    const size_t m = folded.length();
+    const char *data = text.data();
+    const __m128i firstLower = _mm_set1_epi8(folded[0]);
+    const __m128i firstUpper = _mm_set1_epi8(unfoldCase(folded[0]));
+    const __m128i lastLower = _mm_set1_epi8(folded[m - 1]);
+    const __m128i lastUpper = _mm_set1_epi8(unfoldCase(folded[m - 1]));
+
+    size_t count = 0;
+    for (; i + m + 15 <= text.length(); i += 16)
     {
-        if (pattern[i] == pattern[len])
-        {
-            len++;
-            lps[i] = len;
-            i++;
-        }
-        else
+        __m128i head = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i tail = _mm_loadu_si128((const __m128i *)(data + i + m - 1));
+        __m128i headMatch = _mm_or_si128(_mm_cmpeq_epi8(head, firstLower), _mm_cmpeq_epi8(head, firstUpper));
+        __m128i tailMatch = _mm_or_si128(_mm_cmpeq_epi8(tail, lastLower), _mm_cmpeq_epi8(tail, lastUpper));
+        unsigned int candidates = _mm_movemask_epi8(_mm_and_si128(headMatch, tailMatch));
+
+        while (candidates != 0)
         {
-            if (len != 0)
+            size_t pos = i + __builtin_ctz(candidates);
+            if (equalsFolded(data + pos, folded))
             {
-                len = lps[len - 1];
+                count++;
+                if (!positions)
+                    return count;
+                positions->push_back(pos);
             }
-            else
+            candidates &= candidates - 1;
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx2"))) static size_t scanBlocksAVX2(string_view text, const string &folded, size_t &i, vector<size_t> *positions)
+{
+    const size_t m = folded.length();
+    const char *data = text.data();
+    const __m256i firstLower = _mm256_set1_epi8(folded[0]);
+    const __m256i firstUpper = _mm256_set1_epi8(unfoldCase(folded[0]));
+    const __m256i lastLower = _mm256_set1_epi8(folded[m - 1]);
+    const __m256i lastUpper = _mm256_set1_epi8(unfoldCase(folded[m - 1]));
+
+    size_t count = 0;
+    for (; i + m + 31 <= text.length(); i += 32)
+    {
+        __m256i head = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i tail = _mm256_loadu_si256((const __m256i *)(data + i + m - 1));
+        __m256i headMatch = _mm256_or_si256(_mm256_cmpeq_epi8(head, firstLower), _mm256_cmpeq_epi8(head, firstUpper));
+        __m256i tailMatch = _mm256_or_si256(_mm256_cmpeq_epi8(tail, lastLower), _mm256_cmpeq_epi8(tail, lastUpper));
+        unsigned int candidates = _mm256_movemask_epi8(_mm256_and_si256(headMatch, tailMatch));
+
+        while (candidates != 0)
+        {
+            size_t pos = i + __builtin_ctz(candidates);
+            if (equalsFolded(data + pos, folded))
             {
-                lps[i] = 0;
-                i++;
+                count++;
+                if (!positions)
+                    return count;
+                positions->push_back(pos);
             }
+            candidates &= candidates - 1;
         }
     }
-
-    return lps;
+    return count;
 }
 
-vector<size_t> StringSearch::KMPSearch(const string &text, const string &pattern)
+static bool cpuHasAVX2()
 {
-    vector<size_t> positions;
-    if (pattern.empty() || text.empty())
-        return positions;
-
-    // Convert both strings to lowercase for case-insensitive comparison
-    string lowerText = toLowerCase(text);
-    string lowerPattern = toLowerCase(pattern);
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    return hasAVX2;
+}
+#endif
 
-    vector<int> lps(lowerPattern.length(), 0);
+vector<int> StringSearch::computeLPSArray(const string &pattern)
+{
+    int m = pattern.length();
+    vector<int> lps(m, 0);
 
-    // Compute LPS array
     int len = 0;
     int i = 1;
-    while (i < lowerPattern.length())
+
+    while (i < m)
     {
-        if (lowerPattern[i] == lowerPattern[len])
+        if (pattern[i] == pattern[len])
         {
             len++;
             lps[i] = len;
@@ -81,36 +149,12 @@ vector<size_t> StringSearch::KMPSearch(const string &text, const string &pattern
         }
     }
 
-    // Find pattern matches
-    i = 0;
-    int j = 0;
-    while (i < lowerText.length())
-    {
-        if (lowerPattern[j] == lowerText[i])
-        {
-            j++;
-            i++;
-        }
-
-        if (j == lowerPattern.length())
-        {
-            positions.push_back(i - j);
-            j = lps[j - 1];
-        }
-        else if (i < lowerText.length() && lowerPattern[j] != lowerText[i])
-        {
-            if (j != 0)
-            {
-                j = lps[j - 1];
-            }
-            else
-            {
-                i++;
-            }
-        }
-    }
+    return lps;
+}
 
-    return positions;
+vector<size_t> StringSearch::KMPSearch(const string &text, const string &pattern)
+{
+    return Pattern(pattern).findAll(text, true);
 }
 
 long long StringSearch::calculateHash(const string &str, int end)
@@ -143,132 +187,596 @@ long long StringSearch::calculatePowerValue(int m)
 }
 
 vector<size_t> StringSearch::RabinKarpSearch(const string &text, const string &pattern)
+{
+    return Pattern(pattern).findAll(text, false);
+}
+
+vector<size_t> StringSearch::SIMDSearch(const string &text, const string &pattern)
+{
+    return Pattern(pattern).findAll(text, SearchAlgorithm::SIMD);
+}
+
+const char *StringSearch::getSIMDKernelName()
+{
+#ifdef STRING_SEARCH_X86_SIMD
+    return cpuHasAVX2() ? "avx2" : "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+StringSearch::Pattern::Pattern(const string &pattern)
+    : folded(pattern), patternHash(0), highPower(1)
+{
+    for (char &c : folded)
+    {
+        c = foldCase(c);
+    }
+
+    if (!folded.empty())
+    {
+        lps = computeLPSArray(folded);
+        patternHash = (calculateHash(folded, folded.length() - 1) % PRIME + PRIME) % PRIME;
+        highPower = calculatePowerValue(folded.length());
+    }
+}
+
+bool StringSearch::Pattern::empty() const
+{
+    return folded.empty();
+}
+
+size_t StringSearch::Pattern::search(string_view text, SearchAlgorithm algorithm, vector<size_t> *positions) const
+{
+    switch (algorithm)
+    {
+    case SearchAlgorithm::RABIN_KARP:
+        return searchRabinKarp(text, positions);
+    case SearchAlgorithm::SIMD:
+        return searchSIMD(text, positions);
+    default:
+        return searchKMP(text, positions);
+    }
+}
+
+bool StringSearch::Pattern::matches(string_view text, SearchAlgorithm algorithm) const
+{
+    return search(text, algorithm, nullptr) > 0;
+}
+
+bool StringSearch::Pattern::matches(string_view text, bool useKMP) const
+{
+    return matches(text, toAlgorithm(useKMP));
+}
+
+vector<size_t> StringSearch::Pattern::findAll(string_view text, SearchAlgorithm algorithm) const
 {
     vector<size_t> positions;
-    if (pattern.empty() || text.empty())
-        return positions;
+    search(text, algorithm, &positions);
+    return positions;
+}
 
-    // Convert both strings to lowercase for case-insensitive comparison
-    string lowerText = toLowerCase(text);
-    string lowerPattern = toLowerCase(pattern);
+vector<size_t> StringSearch::Pattern::findAll(string_view text, bool useKMP) const
+{
+    return findAll(text, toAlgorithm(useKMP));
+}
 
-    const int prime = 101;
-    const int d = 256;
-    int h = 1;
-    int patternHash = 0;
-    int textHash = 0;
+size_t StringSearch::Pattern::searchKMP(string_view text, vector<size_t> *positions) const
+{
+    size_t m = folded.length();
+    if (m == 0)
+        return 0;
 
-    for (int i = 0; i < lowerPattern.length() - 1; i++)
+    size_t count = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < text.length(); i++)
     {
-        h = (h * d) % prime;
+        char c = foldCase(text[i]);
+        while (j > 0 && c != folded[j])
+        {
+            j = lps[j - 1];
+        }
+        if (c == folded[j])
+        {
+            j++;
+        }
+
+        if (j == m)
+        {
+            count++;
+            if (!positions)
+                return count;
+            positions->push_back(i + 1 - m);
+            j = lps[j - 1];
+        }
     }
+    return count;
+}
 
-    for (int i = 0; i < lowerPattern.length(); i++)
+size_t StringSearch::Pattern::searchRabinKarp(string_view text, vector<size_t> *positions) const
+{
+    size_t m = folded.length();
+    if (m == 0 || text.length() < m)
+        return 0;
+
+    long long textHash = 0;
+    for (size_t i = 0; i < m; i++)
     {
-        patternHash = (d * patternHash + lowerPattern[i]) % prime;
-        textHash = (d * textHash + lowerText[i]) % prime;
+        textHash = (textHash * d + foldCase(text[i])) % PRIME;
     }
+    textHash = (textHash + PRIME) % PRIME;
 
-    for (int i = 0; i <= lowerText.length() - lowerPattern.length(); i++)
+    size_t count = 0;
+    for (size_t i = 0;; i++)
     {
-        if (patternHash == textHash)
+        if (textHash == patternHash)
         {
-            bool match = true;
-            for (int j = 0; j < lowerPattern.length(); j++)
+            // Verify the window to rule out hash collisions
+            size_t j = 0;
+            while (j < m && foldCase(text[i + j]) == folded[j])
             {
-                if (lowerText[i + j] != lowerPattern[j])
-                {
-                    match = false;
-                    break;
-                }
+                j++;
             }
-            if (match)
+            if (j == m)
             {
-                positions.push_back(i);
+                count++;
+                if (!positions)
+                    return count;
+                positions->push_back(i);
             }
         }
 
-        if (i < lowerText.length() - lowerPattern.length())
+        if (i + m >= text.length())
+            break;
+        textHash = recalculateHash(textHash, foldCase(text[i]), foldCase(text[i + m]), highPower);
+    }
+    return count;
+}
+
+size_t StringSearch::Pattern::searchSIMD(string_view text, vector<size_t> *positions) const
+{
+    size_t m = folded.length();
+    if (m == 0 || text.length() < m)
+        return 0;
+
+    size_t count = 0;
+    size_t i = 0;
+#ifdef STRING_SEARCH_X86_SIMD
+    count = cpuHasAVX2() ? scanBlocksAVX2(text, folded, i, positions) : scanBlocksSSE2(text, folded, i, positions);
+    if (count > 0 && !positions)
+        return count;
+#endif
+
+    // Scalar fallback for the remaining windows
+    for (; i + m <= text.length(); i++)
+    {
+        if (foldCase(text[i]) == folded[0] && equalsFolded(text.data() + i, folded))
         {
-            textHash = (d * (textHash - lowerText[i] * h) + lowerText[i + lowerPattern.length()]) % prime;
-            if (textHash < 0)
-            {
-                textHash += prime;
-            }
+            count++;
+            if (!positions)
+                return count;
+            positions->push_back(i);
         }
     }
+    return count;
+}
 
-    return positions;
+// Matches the pattern once against each distinct value of an interned column
+static IdBitset matchDictionary(const StringDictionary &dictionary, const StringSearch::Pattern &pattern, SearchAlgorithm algorithm)
+{
+    IdBitset matched(dictionary.size());
+    for (unsigned int id = 0; id < dictionary.size(); id++)
+    {
+        if (pattern.matches(dictionary.lookup(id), algorithm))
+            matched.insert(id);
+    }
+    return matched;
+}
+
+vector<ConstUser> StringSearch::searchUsersByName(const UserStore &users, const string &searchPattern, bool useKMP)
+{
+    return searchUsersByName(users, searchPattern, toAlgorithm(useKMP));
 }
 
-vector<User *> StringSearch::searchUsersByName(const vector<User *> &users, const string &searchPattern, bool useKMP)
+vector<ConstUser> StringSearch::searchUsersByName(const UserStore &users, const string &searchPattern, SearchAlgorithm algorithm)
 {
-    vector<User *> results;
-    for (User *user : users)
+    vector<ConstUser> results;
+    Pattern pattern(searchPattern);
+    const StringColumn &names = users.getNames();
+    for (size_t row = 0; row < names.size(); row++)
     {
-        string name = user->getName();
-        vector<size_t> matches = useKMP ? KMPSearch(name, searchPattern) : RabinKarpSearch(name, searchPattern);
+        if (pattern.matches(names[row], algorithm))
+        {
+            results.push_back(users[row]);
+        }
+    }
+    return results;
+}
+
+vector<ConstUser> StringSearch::searchUsersByLocation(const UserStore &users, const string &searchPattern, bool useKMP)
+{
+    return searchUsersByLocation(users, searchPattern, toAlgorithm(useKMP));
+}
 
-        if (!matches.empty())
+vector<ConstUser> StringSearch::searchUsersByLocation(const UserStore &users, const string &searchPattern, SearchAlgorithm algorithm)
+{
+    vector<ConstUser> results;
+    IdBitset matchedLocations = matchDictionary(users.getLocationDictionary(), Pattern(searchPattern), algorithm);
+    const vector<unsigned int> &locationIds = users.getLocationIds();
+    for (size_t row = 0; row < locationIds.size(); row++)
+    {
+        if (matchedLocations.contains(locationIds[row]))
         {
-            results.push_back(user);
+            results.push_back(users[row]);
         }
     }
     return results;
 }
 
-vector<User *> StringSearch::searchUsersByLocation(const vector<User *> &users, const string &searchPattern, bool useKMP)
+vector<ConstUser> StringSearch::searchUsersByInterest(const UserStore &users, const string &searchPattern, bool useKMP)
+{
+    return searchUsersByInterest(users, searchPattern, toAlgorithm(useKMP));
+}
+
+vector<ConstUser> StringSearch::searchUsersByInterest(const UserStore &users, const string &searchPattern, SearchAlgorithm algorithm)
 {
-    vector<User *> results;
-    for (User *user : users)
+    vector<ConstUser> results;
+    IdBitset matchedInterests = matchDictionary(users.getInterestDictionary(), Pattern(searchPattern), algorithm);
+    for (size_t row = 0; row < users.size(); row++)
     {
-        string location = user->getLocation();
-        vector<size_t> matches = useKMP ? KMPSearch(location, searchPattern) : RabinKarpSearch(location, searchPattern);
+        if (users.hasAnyInterest(row, matchedInterests))
+        {
+            results.push_back(users[row]);
+        }
+    }
+    return results;
+}
+
+vector<ConstUser> StringSearch::searchUsersByProfileData(const UserStore &users, const string &key, const string &searchPattern, bool useKMP)
+{
+    return searchUsersByProfileData(users, key, searchPattern, toAlgorithm(useKMP));
+}
 
-        if (!matches.empty())
+vector<ConstUser> StringSearch::searchUsersByProfileData(const UserStore &users, const string &key, const string &searchPattern, SearchAlgorithm algorithm)
+{
+    vector<ConstUser> results;
+    Pattern pattern(searchPattern);
+    for (size_t row = 0; row < users.size(); row++)
+    {
+        const string *value = users.findProfileData(row, key);
+        if (value && pattern.matches(*value, algorithm))
         {
-            results.push_back(user);
+            results.push_back(users[row]);
         }
     }
     return results;
 }
 
-vector<User *> StringSearch::searchUsersByInterest(const vector<User *> &users, const string &searchPattern, bool useKMP)
+StringSearch::ApproximatePattern::ApproximatePattern(const string &pattern)
+    : folded(pattern), peq(256, 0)
 {
-    vector<User *> results;
-    for (User *user : users)
+    for (char &c : folded)
     {
-        bool found = false;
-        for (const string &interest : user->getInterests())
+        c = foldCase(c);
+    }
+
+    for (size_t i = 0; i < folded.length() && i < 64; i++)
+    {
+        unsigned char c = folded[i];
+        peq[c] |= 1ULL << i;
+        peq[(unsigned char)unfoldCase(c)] |= 1ULL << i;
+    }
+}
+
+size_t StringSearch::ApproximatePattern::length() const
+{
+    return folded.length();
+}
+
+int StringSearch::ApproximatePattern::distance(string_view text) const
+{
+    size_t m = folded.length();
+    if (m == 0)
+        return 0;
+    if (m > 64)
+        return dynamicProgrammingDistance(text);
+
+    // Vertical deltas of the DP column, one bit per pattern position
+    unsigned long long positive = ~0ULL;
+    unsigned long long negative = 0;
+    unsigned long long lastBit = 1ULL << (m - 1);
+    int score = m;
+    int best = m;
+
+    for (char ch : text)
+    {
+        unsigned long long eq = peq[(unsigned char)ch];
+        unsigned long long xv = eq | negative;
+        unsigned long long xh = (((eq & positive) + positive) ^ positive) | eq;
+        unsigned long long horizontalPositive = negative | ~(xh | positive);
+        unsigned long long horizontalNegative = positive & xh;
+
+        if (horizontalPositive & lastBit)
+            score++;
+        else if (horizontalNegative & lastBit)
+            score--;
+
+        // No carry-in: a match may start anywhere in the text
+        horizontalPositive <<= 1;
+        horizontalNegative <<= 1;
+        positive = horizontalNegative | ~(xv | horizontalPositive);
+        negative = horizontalPositive & xv;
+
+        best = min(best, score);
+    }
+    return best;
+}
+
+int StringSearch::ApproximatePattern::dynamicProgrammingDistance(string_view text) const
+{
+    size_t m = folded.length();
+    vector<int> column(m + 1);
+    for (size_t i = 0; i <= m; i++)
+    {
+        column[i] = i;
+    }
+
+    int best = m;
+    for (char ch : text)
+    {
+        char c = foldCase(ch);
+        int diagonal = column[0]; // Row 0 stays 0: a match may start anywhere
+        for (size_t i = 1; i <= m; i++)
         {
-            vector<size_t> matches = useKMP ? KMPSearch(interest, searchPattern) : RabinKarpSearch(interest, searchPattern);
+            int above = column[i];
+            column[i] = min({above + 1, column[i - 1] + 1, diagonal + (folded[i - 1] == c ? 0 : 1)});
+            diagonal = above;
+        }
+        best = min(best, column[m]);
+    }
+    return best;
+}
 
-            if (!matches.empty())
-            {
-                results.push_back(user);
-                found = true;
-                break;
-            }
+int StringSearch::approximateDistance(const string &text, const string &pattern)
+{
+    return ApproximatePattern(pattern).distance(text);
+}
+
+vector<StringSearch::FuzzyMatch> StringSearch::fuzzySearchUsersByName(const UserStore &users, const string &searchPattern, int maxDistance)
+{
+    vector<FuzzyMatch> results;
+    ApproximatePattern pattern(searchPattern);
+    if (pattern.length() == 0)
+        return results;
+
+    const StringColumn &names = users.getNames();
+    for (size_t row = 0; row < names.size(); row++)
+    {
+        int distance = pattern.distance(names[row]);
+        if (distance <= maxDistance)
+        {
+            results.push_back({users[row], distance});
+        }
+    }
+
+    stable_sort(results.begin(), results.end(), [](const FuzzyMatch &a, const FuzzyMatch &b)
+                { return a.distance < b.distance; });
+    return results;
+}
+
+// Interned fields are tested through the set of dictionary values that matched
+static bool matchesField(const UserStore &users, size_t row, SearchField field, const StringSearch::Pattern &pattern, SearchAlgorithm algorithm, const IdBitset &matchedValues)
+{
+    switch (field)
+    {
+    case SearchField::NAME:
+        return pattern.matches(users.getNames()[row], algorithm);
+    case SearchField::LOCATION:
+        return matchedValues.contains(users.getLocationIds()[row]);
+    case SearchField::INTEREST:
+        return users.hasAnyInterest(row, matchedValues);
+    }
+    return false;
+}
+
+vector<ConstUser> StringSearch::parallelSearchUsers(const UserStore &users, SearchField field, const string &searchPattern, SearchAlgorithm algorithm)
+{
+    Pattern pattern(searchPattern);
+    ThreadPool &pool = ThreadPool::shared();
+
+    IdBitset matchedValues;
+    if (field == SearchField::LOCATION)
+        matchedValues = matchDictionary(users.getLocationDictionary(), pattern, algorithm);
+    else if (field == SearchField::INTEREST)
+        matchedValues = matchDictionary(users.getInterestDictionary(), pattern, algorithm);
+
+    if (users.size() < PARALLEL_SEARCH_CUTOFF || pool.getThreadCount() < 2)
+    {
+        vector<ConstUser> results;
+        for (size_t row = 0; row < users.size(); row++)
+        {
+            if (matchesField(users, row, field, pattern, algorithm, matchedValues))
+                results.push_back(users[row]);
+        }
+        return results;
+    }
+
+    // A few chunks per thread keeps the load balanced when match costs vary
+    size_t chunkCount = pool.getThreadCount() * 4;
+    size_t grainSize = max(PARALLEL_SEARCH_CUTOFF / 4, (users.size() + chunkCount - 1) / chunkCount);
+    chunkCount = (users.size() + grainSize - 1) / grainSize;
+
+    vector<vector<size_t>> partialResults(chunkCount);
+    pool.parallelFor(0, users.size(), grainSize, [&](size_t begin, size_t end)
+                     {
+                         vector<size_t> &partial = partialResults[begin / grainSize];
+                         for (size_t row = begin; row < end; row++)
+                         {
+                             if (matchesField(users, row, field, pattern, algorithm, matchedValues))
+                                 partial.push_back(row);
+                         } });
+
+    // Chunks cover consecutive ranges, so concatenating them preserves user order
+    size_t total = 0;
+    for (const auto &partial : partialResults)
+    {
+        total += partial.size();
+    }
+
+    vector<ConstUser> results;
+    results.reserve(total);
+    for (const auto &partial : partialResults)
+    {
+        for (size_t row : partial)
+        {
+            results.push_back(users[row]);
         }
     }
     return results;
 }
 
-vector<User *> StringSearch::searchUsersByProfileData(const vector<User *> &users, const string &key, const string &searchPattern, bool useKMP)
+vector<StringSearch::NeighbourhoodMatch> StringSearch::searchNeighbourhood(const Graph &graph, const UserStore &users, const string &sourceId, int maxHops, SearchField field, const string &searchPattern, size_t limit, SearchAlgorithm algorithm)
+{
+    vector<NeighbourhoodMatch> results;
+    Pattern pattern(searchPattern);
+
+    // Interned values are matched on first sight only, so the dictionaries are never scanned whole
+    unordered_map<unsigned int, bool> matchedValues;
+    auto valueMatches = [&](unsigned int id, const StringDictionary &dictionary)
+    {
+        auto it = matchedValues.find(id);
+        if (it == matchedValues.end())
+            it = matchedValues.emplace(id, pattern.matches(dictionary.lookup(id), algorithm)).first;
+        return it->second;
+    };
+
+    graph.boundedBFS(sourceId, maxHops, [&](const string &userId, int hops)
+                     {
+                         size_t row = users.findRow(userId);
+                         if (row == UserStore::NOT_FOUND)
+                             return true;
+
+                         bool matches = false;
+                         switch (field)
+                         {
+                         case SearchField::NAME:
+                             matches = pattern.matches(users.getNames()[row], algorithm);
+                             break;
+                         case SearchField::LOCATION:
+                             matches = valueMatches(users.getLocationIds()[row], users.getLocationDictionary());
+                             break;
+                         case SearchField::INTEREST:
+                         {
+                             InterestRange interests = users.getInterests(row);
+                             for (const unsigned int *id = interests.idsBegin(); id != interests.idsEnd() && !matches; ++id)
+                             {
+                                 matches = valueMatches(*id, users.getInterestDictionary());
+                             }
+                             break;
+                         }
+                         }
+
+                         if (matches)
+                             results.push_back({users[row], hops});
+                         return limit == 0 || results.size() < limit; });
+    return results;
+}
+
+// Moves the set flags of matched into ids (ascending) and clears them for the next user
+static void collectPatternIds(vector<char> &matched, vector<int> &ids)
+{
+    for (size_t id = 0; id < matched.size(); id++)
+    {
+        if (matched[id])
+        {
+            ids.push_back(id);
+            matched[id] = 0;
+        }
+    }
+}
+
+// Patterns found in each distinct value of an interned column: the patterns of
+// value id are patternIds[offsets[id] .. offsets[id + 1])
+struct DictionaryMatches
 {
-    vector<User *> results;
-    for (User *user : users)
+    vector<unsigned int> offsets;
+    vector<int> patternIds;
+
+    DictionaryMatches(const StringDictionary &dictionary, const AhoCorasick &automaton)
     {
-        if (user->hasProfileData(key))
+        offsets.push_back(0);
+        for (unsigned int id = 0; id < dictionary.size(); id++)
         {
-            string value = user->getProfileData(key);
-            vector<size_t> matches = useKMP ? KMPSearch(value, searchPattern) : RabinKarpSearch(value, searchPattern);
+            automaton.scan(dictionary.lookup(id), [this](int patternId, size_t)
+                           { patternIds.push_back(patternId); });
+            offsets.push_back(patternIds.size());
+        }
+    }
 
-            if (!matches.empty())
+    // Marks the patterns of value id; returns the number of newly set flags
+    size_t mark(unsigned int id, vector<char> &matched) const
+    {
+        size_t newlyMatched = 0;
+        for (unsigned int i = offsets[id]; i < offsets[id + 1]; i++)
+        {
+            if (!matched[patternIds[i]])
             {
-                results.push_back(user);
+                matched[patternIds[i]] = 1;
+                newlyMatched++;
             }
         }
+        return newlyMatched;
+    }
+};
+
+vector<StringSearch::MultiPatternMatch> StringSearch::searchUsersByInterests(const UserStore &users, const vector<string> &searchPatterns)
+{
+    vector<MultiPatternMatch> results;
+    AhoCorasick automaton(searchPatterns);
+    DictionaryMatches interestMatches(users.getInterestDictionary(), automaton);
+    vector<char> matched(searchPatterns.size(), 0);
+
+    for (size_t row = 0; row < users.size(); row++)
+    {
+        size_t found = 0;
+        InterestRange interests = users.getInterests(row);
+        for (const unsigned int *id = interests.idsBegin(); id != interests.idsEnd(); ++id)
+        {
+            found += interestMatches.mark(*id, matched);
+        }
+
+        if (found > 0)
+        {
+            results.push_back({users[row], {}});
+            collectPatternIds(matched, results.back().patternIds);
+        }
+    }
+    return results;
+}
+
+vector<StringSearch::MultiPatternMatch> StringSearch::searchUsersByKeywords(const UserStore &users, const vector<string> &searchPatterns)
+{
+    vector<MultiPatternMatch> results;
+    AhoCorasick automaton(searchPatterns);
+    DictionaryMatches locationMatches(users.getLocationDictionary(), automaton);
+    DictionaryMatches interestMatches(users.getInterestDictionary(), automaton);
+    vector<char> matched(searchPatterns.size(), 0);
+
+    for (size_t row = 0; row < users.size(); row++)
+    {
+        size_t found = automaton.markMatches(users.getNames()[row], matched);
+        found += locationMatches.mark(users.getLocationIds()[row], matched);
+        InterestRange interests = users.getInterests(row);
+        for (const unsigned int *id = interests.idsBegin(); id != interests.idsEnd(); ++id)
+        {
+            found += interestMatches.mark(*id, matched);
+        }
+
+        if (found > 0)
+        {
+            results.push_back({users[row], {}});
+            collectPatternIds(matched, results.back().patternIds);
+        }
     }
     return results;
-}
\ No newline at end of file
+}
@@ -0,0 +1,146 @@
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t threadCount) : stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            taskAvailable.wait(lock, [this]
+                               { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+                return;
+
+            task = move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return workers.size();
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        tasks.push(move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grainSize, const function<void(size_t, size_t)> &body)
+{
+    if (begin >= end)
+        return;
+    if (grainSize == 0)
+        grainSize = 1;
+
+    size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+    if (chunkCount == 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    // Shared with the helper tasks, which may outlive this call if they start late
+    struct State
+    {
+        function<void(size_t, size_t)> body;
+        size_t begin, end, grainSize, chunkCount;
+        atomic<size_t> nextChunk{0};
+        size_t finishedChunks = 0;
+        exception_ptr error;
+        mutex doneMutex;
+        condition_variable done;
+    };
+
+    auto state = make_shared<State>();
+    state->body = body;
+    state->begin = begin;
+    state->end = end;
+    state->grainSize = grainSize;
+    state->chunkCount = chunkCount;
+
+    auto runChunks = [](const shared_ptr<State> &s)
+    {
+        size_t chunk;
+        while ((chunk = s->nextChunk++) < s->chunkCount)
+        {
+            size_t chunkBegin = s->begin + chunk * s->grainSize;
+            size_t chunkEnd = min(s->end, chunkBegin + s->grainSize);
+
+            exception_ptr error;
+            try
+            {
+                s->body(chunkBegin, chunkEnd);
+            }
+            catch (...)
+            {
+                error = current_exception();
+            }
+
+            lock_guard<mutex> lock(s->doneMutex);
+            if (error && !s->error)
+                s->error = error;
+            if (++s->finishedChunks == s->chunkCount)
+                s->done.notify_all();
+        }
+    };
+
+    size_t helpers = min(workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helpers; i++)
+    {
+        submit([state, runChunks]
+               { runChunks(state); });
+    }
+
+    runChunks(state);
+
+    unique_lock<mutex> lock(state->doneMutex);
+    state->done.wait(lock, [&state]
+                     { return state->finishedChunks == state->chunkCount; });
+    if (state->error)
+        rethrow_exception(state->error);
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
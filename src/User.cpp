@@ -1,94 +1,109 @@
 #include "../include/User.hpp"
+#include "../include/UserStore.hpp"
 #include <sstream>
 #include <algorithm>
 
-User::User(const string &id, const string &userName, int userAge, const string &userLocation)
-    : userId(id), name(userName), age(userAge), location(userLocation) {}
+ConstUser::ConstUser(const UserStore *userStore, size_t userRow) : store(userStore), row(userRow) {}
 
-string User::getUserId() const
+User::User(UserStore *userStore, size_t userRow) : ConstUser(userStore, userRow), writableStore(userStore) {}
+
+size_t ConstUser::getRow() const
+{
+    return row;
+}
+
+string_view ConstUser::getUserId() const
 {
-    return userId;
+    return store->getIds()[row];
 }
 
-string User::getName() const
+string_view ConstUser::getName() const
 {
-    return name;
+    return store->getNames()[row];
 }
 
-int User::getAge() const
+int ConstUser::getAge() const
 {
-    return age;
+    return store->getAges()[row];
 }
 
-string User::getLocation() const
+string_view ConstUser::getLocation() const
 {
-    return location;
+    return store->getLocation(row);
 }
 
-vector<string> User::getInterests() const
+InterestRange ConstUser::getInterests() const
 {
-    return interests;
+    return store->getInterests(row);
 }
 
 void User::setName(const string &newName)
 {
-    name = newName;
+    writableStore->setName(row, newName);
 }
 
 void User::setAge(int newAge)
 {
-    age = newAge;
+    writableStore->setAge(row, newAge);
 }
 
 void User::setLocation(const string &newLocation)
 {
-    location = newLocation;
+    writableStore->setLocation(row, newLocation);
 }
 
 void User::addInterest(const string &interest)
 {
-    for (const auto &existingInterest : interests)
-    {
-        if (existingInterest == interest)
-            return;
-    }
-    interests.push_back(interest);
+    writableStore->addInterest(row, interest);
 }
 
 void User::removeInterest(const string &interest)
 {
-    auto it = find(interests.begin(), interests.end(), interest);
-    if (it != interests.end())
-    {
-        interests.erase(it);
-    }
+    writableStore->removeInterest(row, interest);
 }
 
 void User::addProfileData(const string &key, const string &value)
 {
-    profileData[key] = value;
+    writableStore->setProfileData(row, key, value);
 }
 
-string User::getProfileData(const string &key) const
+const string &ConstUser::getProfileData(const string &key) const
 {
-    auto it = profileData.find(key);
-    return (it != profileData.end()) ? it->second : "";
+    static const string empty;
+    const string *value = store->findProfileData(row, key);
+    return value ? *value : empty;
 }
 
-bool User::hasProfileData(const string &key) const
+bool ConstUser::hasProfileData(const string &key) const
 {
-    return profileData.find(key) != profileData.end();
+    return store->findProfileData(row, key) != nullptr;
 }
 
-string User::toString() const
+bool ConstUser::operator==(const ConstUser &other) const
+{
+    return store == other.store && row == other.row;
+}
+
+bool ConstUser::operator!=(const ConstUser &other) const
+{
+    return !(*this == other);
+}
+
+string ConstUser::toString() const
 {
     try
     {
+        string_view userId = getUserId();
+        string_view name = getName();
+        string_view location = getLocation();
+        InterestRange interests = getInterests();
+        vector<pair<string, string>> profileData = store->getProfileData(row);
+
         stringstream ss;
-        ss << "User ID: " << (userId.empty() ? "N/A" : userId) << "\n"
-           << "Name: " << (name.empty() ? "N/A" : name) << "\n"
-           << "Age: " << age << "\n"
-           << "Location: " << (location.empty() ? "N/A" : location) << "\n"
+        ss << "User ID: " << (userId.empty() ? string_view("N/A") : userId) << "\n"
+           << "Name: " << (name.empty() ? string_view("N/A") : name) << "\n"
+           << "Age: " << getAge() << "\n"
+           << "Location: " << (location.empty() ? string_view("N/A") : location) << "\n"
            << "Interests: ";
 
         if (interests.empty())
@@ -0,0 +1,138 @@
+#include "../include/UserIdIndex.hpp"
+
+using namespace std;
+
+UserIdIndex::UserIdIndex() : count(0) {}
+
+unsigned int UserIdIndex::hashId(string_view id)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (char c : id)
+    {
+        hash = (hash ^ (unsigned char)c) * 16777619u;
+    }
+    return hash;
+}
+
+void UserIdIndex::grow()
+{
+    vector<Slot> old = move(slots);
+    slots.assign(old.empty() ? 16 : old.size() * 2, {EMPTY, 0});
+
+    size_t mask = slots.size() - 1;
+    for (const Slot &slot : old)
+    {
+        if (slot.row == EMPTY)
+            continue;
+
+        size_t i = slot.hash & mask;
+        while (slots[i].row != EMPTY)
+        {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
+
+bool UserIdIndex::insert(unsigned int row, const StringColumn &ids)
+{
+    if ((count + 1) * 2 > slots.size())
+        grow();
+
+    string_view id = ids[row];
+    unsigned int hash = hashId(id);
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].row != EMPTY)
+    {
+        if (slots[i].hash == hash && ids[slots[i].row] == id)
+            return false;
+        i = (i + 1) & mask;
+    }
+
+    slots[i] = {row, hash};
+    count++;
+    return true;
+}
+
+size_t UserIdIndex::find(string_view id, const StringColumn &ids) const
+{
+    if (slots.empty())
+        return NOT_FOUND;
+
+    unsigned int hash = hashId(id);
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; slots[i].row != EMPTY; i = (i + 1) & mask)
+    {
+        if (slots[i].hash == hash && ids[slots[i].row] == id)
+            return slots[i].row;
+    }
+    return NOT_FOUND;
+}
+
+void UserIdIndex::erase(unsigned int row, const StringColumn &ids)
+{
+    if (slots.empty())
+        return;
+
+    unsigned int hash = hashId(ids[row]);
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].row != EMPTY && slots[i].row != row)
+    {
+        i = (i + 1) & mask;
+    }
+    if (slots[i].row == EMPTY)
+        return;
+
+    // Backward-shift deletion: pull later entries of the cluster into the hole when
+    // their home slot is not between the hole and their current slot
+    size_t hole = i;
+    for (size_t j = (i + 1) & mask; slots[j].row != EMPTY; j = (j + 1) & mask)
+    {
+        size_t home = slots[j].hash & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole] = {EMPTY, 0};
+    count--;
+}
+
+void UserIdIndex::relabel(unsigned int row, unsigned int newRow, const StringColumn &ids)
+{
+    if (slots.empty())
+        return;
+
+    size_t mask = slots.size() - 1;
+    for (size_t i = hashId(ids[row]) & mask; slots[i].row != EMPTY; i = (i + 1) & mask)
+    {
+        if (slots[i].row == row)
+        {
+            slots[i].row = newRow;
+            return;
+        }
+    }
+}
+
+void UserIdIndex::reserve(size_t rows)
+{
+    while (rows * 2 > slots.size())
+    {
+        grow();
+    }
+}
+
+void UserIdIndex::clear()
+{
+    slots.clear();
+    count = 0;
+}
+
+size_t UserIdIndex::size() const
+{
+    return count;
+}
@@ -0,0 +1,330 @@
+#include "../include/UserStore.hpp"
+#include <algorithm>
+
+using namespace std;
+
+UserStore::UserStore() : deadInterestSlots(0) {}
+
+User UserStore::addUser(string_view id, string_view name, int age, string_view location)
+{
+    ids.push_back(id);
+    names.push_back(name);
+    ages.push_back(age);
+    locationIds.push_back(locationDictionary.intern(location));
+    interestStart.push_back(interestIds.size());
+    interestCount.push_back(0);
+    idIndex.insert(ids.size() - 1, ids);
+    return User(this, ids.size() - 1);
+}
+
+bool UserStore::removeUser(string_view id)
+{
+    size_t row = idIndex.find(id, ids);
+    if (row == NOT_FOUND)
+        return false;
+
+    size_t last = ids.size() - 1;
+    size_t removedStart = interestStart[row];
+    size_t removedCount = interestCount[row];
+    idIndex.erase(row, ids);
+    if (row != last)
+        idIndex.relabel(last, row, ids);
+
+    ids.swapRemove(row);
+    names.swapRemove(row);
+    ages[row] = ages[last];
+    ages.pop_back();
+    locationIds[row] = locationIds[last];
+    locationIds.pop_back();
+    interestStart[row] = interestStart[last];
+    interestStart.pop_back();
+    interestCount[row] = interestCount[last];
+    interestCount.pop_back();
+    releaseInterests(removedStart, removedCount);
+
+    for (auto &column : profileColumns)
+    {
+        auto &values = column.second;
+        values.erase(row);
+        auto moved = values.find(last);
+        if (moved != values.end())
+        {
+            string value = move(moved->second);
+            values.erase(moved);
+            values[row] = move(value);
+        }
+    }
+    return true;
+}
+
+void UserStore::reserve(size_t rows)
+{
+    ids.reserve(rows);
+    idIndex.reserve(rows);
+    names.reserve(rows);
+    ages.reserve(rows);
+    locationIds.reserve(rows);
+    interestStart.reserve(rows);
+    interestCount.reserve(rows);
+}
+
+void UserStore::clear()
+{
+    ids.clear();
+    names.clear();
+    ages.clear();
+    locationIds.clear();
+    locationDictionary.clear();
+    interestStart.clear();
+    interestCount.clear();
+    interestIds.clear();
+    interestDictionary.clear();
+    deadInterestSlots = 0;
+    profileColumns.clear();
+    idIndex.clear();
+}
+
+size_t UserStore::size() const
+{
+    return ids.size();
+}
+
+bool UserStore::empty() const
+{
+    return ids.empty();
+}
+
+User UserStore::operator[](size_t row)
+{
+    return User(this, row);
+}
+
+ConstUser UserStore::operator[](size_t row) const
+{
+    return ConstUser(this, row);
+}
+
+UserStore::iterator UserStore::begin() const
+{
+    return iterator(this, 0);
+}
+
+UserStore::iterator UserStore::end() const
+{
+    return iterator(this, ids.size());
+}
+
+size_t UserStore::findRow(string_view id) const
+{
+    return idIndex.find(id, ids);
+}
+
+bool UserStore::contains(string_view id) const
+{
+    return idIndex.find(id, ids) != UserIdIndex::NOT_FOUND;
+}
+
+const StringColumn &UserStore::getIds() const
+{
+    return ids;
+}
+
+const StringColumn &UserStore::getNames() const
+{
+    return names;
+}
+
+const vector<int> &UserStore::getAges() const
+{
+    return ages;
+}
+
+const vector<unsigned int> &UserStore::getLocationIds() const
+{
+    return locationIds;
+}
+
+const StringDictionary &UserStore::getLocationDictionary() const
+{
+    return locationDictionary;
+}
+
+const StringDictionary &UserStore::getInterestDictionary() const
+{
+    return interestDictionary;
+}
+
+string_view UserStore::getLocation(size_t row) const
+{
+    return locationDictionary.lookup(locationIds[row]);
+}
+
+InterestRange UserStore::getInterests(size_t row) const
+{
+    const unsigned int *first = interestIds.data() + interestStart[row];
+    return InterestRange(first, first + interestCount[row], &interestDictionary);
+}
+
+bool UserStore::hasInterest(size_t row, unsigned int interestId) const
+{
+    const unsigned int *first = interestIds.data() + interestStart[row];
+    return find(first, first + interestCount[row], interestId) != first + interestCount[row];
+}
+
+bool UserStore::hasAnyInterest(size_t row, const IdBitset &interests) const
+{
+    const unsigned int *first = interestIds.data() + interestStart[row];
+    for (unsigned int i = 0; i < interestCount[row]; i++)
+    {
+        if (interests.contains(first[i]))
+            return true;
+    }
+    return false;
+}
+
+void UserStore::setName(size_t row, const string &name)
+{
+    names.set(row, name);
+}
+
+void UserStore::setAge(size_t row, int age)
+{
+    ages[row] = age;
+}
+
+void UserStore::setLocation(size_t row, const string &location)
+{
+    locationIds[row] = locationDictionary.intern(location);
+}
+
+void UserStore::moveInterestsToEnd(size_t row)
+{
+    if (interestStart[row] + interestCount[row] == interestIds.size())
+        return;
+
+    // The old block is left behind as unused slots
+    deadInterestSlots += interestCount[row];
+    if (deadInterestSlots > interestIds.size() / 2)
+    {
+        compactInterests(row);
+        return;
+    }
+
+    size_t newStart = interestIds.size();
+    for (unsigned int i = 0; i < interestCount[row]; i++)
+    {
+        interestIds.push_back(interestIds[interestStart[row] + i]);
+    }
+    interestStart[row] = newStart;
+}
+
+void UserStore::releaseInterests(size_t start, size_t count)
+{
+    if (start + count == interestIds.size())
+    {
+        // The last block is simply cut off
+        interestIds.resize(start);
+        return;
+    }
+
+    deadInterestSlots += count;
+    if (deadInterestSlots > interestIds.size() / 2)
+        compactInterests();
+}
+
+void UserStore::compactInterests(size_t lastRow)
+{
+    vector<unsigned int> compacted;
+    compacted.reserve(interestIds.size() - deadInterestSlots);
+    auto append = [&](size_t row)
+    {
+        size_t start = compacted.size();
+        compacted.insert(compacted.end(), interestIds.begin() + interestStart[row],
+                         interestIds.begin() + interestStart[row] + interestCount[row]);
+        interestStart[row] = start;
+    };
+
+    for (size_t row = 0; row < interestStart.size(); row++)
+    {
+        if (row != lastRow)
+            append(row);
+    }
+    if (lastRow != NOT_FOUND)
+        append(lastRow);
+
+    interestIds = move(compacted);
+    deadInterestSlots = 0;
+}
+
+void UserStore::addInterest(size_t row, const string &interest)
+{
+    unsigned int id = interestDictionary.intern(interest);
+    if (hasInterest(row, id))
+        return;
+
+    moveInterestsToEnd(row);
+    interestIds.push_back(id);
+    interestCount[row]++;
+}
+
+void UserStore::removeInterest(size_t row, const string &interest)
+{
+    unsigned int id = interestDictionary.find(interest);
+    if (id == StringDictionary::NOT_FOUND)
+        return;
+
+    auto first = interestIds.begin() + interestStart[row];
+    auto last = first + interestCount[row];
+    auto it = find(first, last, id);
+    if (it != last)
+    {
+        rotate(it, it + 1, last);
+        interestCount[row]--;
+        releaseInterests(interestStart[row] + interestCount[row], 1);
+    }
+}
+
+void UserStore::setProfileData(size_t row, const string &key, const string &value)
+{
+    profileColumns[key][row] = value;
+}
+
+const string *UserStore::findProfileData(size_t row, const string &key) const
+{
+    auto column = profileColumns.find(key);
+    if (column == profileColumns.end())
+        return nullptr;
+
+    auto value = column->second.find(row);
+    return value == column->second.end() ? nullptr : &value->second;
+}
+
+vector<pair<string, string>> UserStore::getProfileData(size_t row) const
+{
+    vector<pair<string, string>> data;
+    for (const auto &[key, column] : profileColumns)
+    {
+        auto value = column.find(row);
+        if (value != column.end())
+        {
+            data.push_back({key, value->second});
+        }
+    }
+    return data;
+}
+
+vector<string> UserStore::getProfileKeys() const
+{
+    vector<string> keys;
+    for (const auto &column : profileColumns)
+    {
+        keys.push_back(column.first);
+    }
+    return keys;
+}
+
+const unordered_map<unsigned int, string> *UserStore::findProfileColumn(const string &key) const
+{
+    auto column = profileColumns.find(key);
+    return column == profileColumns.end() ? nullptr : &column->second;
+}
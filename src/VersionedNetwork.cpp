@@ -0,0 +1,151 @@
+#include "../include/VersionedNetwork.hpp"
+#include <atomic>
+#include <stdexcept>
+
+using namespace std;
+
+void NetworkUpdate::addUser(const string &id, const string &name, int age, const string &location, const vector<string> &interests)
+{
+    operations.push_back({OperationType::AddUser, id, name, age, location, interests});
+}
+
+void NetworkUpdate::addConnection(const string &user1, const string &user2)
+{
+    operations.push_back({OperationType::AddConnection, user1, user2, 0, "", {}});
+}
+
+void NetworkUpdate::removeConnection(const string &user1, const string &user2)
+{
+    operations.push_back({OperationType::RemoveConnection, user1, user2, 0, "", {}});
+}
+
+void NetworkUpdate::removeUser(const string &id)
+{
+    operations.push_back({OperationType::RemoveUser, id, "", 0, "", {}});
+}
+
+size_t NetworkUpdate::size() const
+{
+    return operations.size();
+}
+
+bool NetworkUpdate::empty() const
+{
+    return operations.empty();
+}
+
+VersionedNetwork::VersionedNetwork() : current(make_shared<NetworkSnapshot>()) {}
+
+shared_ptr<const NetworkSnapshot> VersionedNetwork::snapshot() const
+{
+    return atomic_load(&current);
+}
+
+unsigned long long VersionedNetwork::commit(const NetworkUpdate &update)
+{
+    lock_guard<mutex> lock(writerMutex);
+    shared_ptr<const NetworkSnapshot> base = atomic_load(&current);
+    if (update.empty())
+        return base->version;
+
+    auto next = make_shared<NetworkSnapshot>(*base);
+    next->version = base->version + 1;
+    // Copied on the first operation that changes the users
+    shared_ptr<UserStore> users;
+    auto writableUsers = [&]() -> UserStore &
+    {
+        if (!users)
+        {
+            users = make_shared<UserStore>(*base->users);
+            next->users = users;
+        }
+        return *users;
+    };
+
+    // Each operation is checked against the result of the ones before it, so a batch may
+    // connect the users it adds
+    for (const auto &operation : update.operations)
+    {
+        const string &id = operation.id;
+        switch (operation.type)
+        {
+        case NetworkUpdate::OperationType::AddUser:
+        {
+            if (id.empty())
+                throw runtime_error("user ID must not be empty");
+            if (next->users->contains(id))
+                throw runtime_error("user " + id + " already exists");
+
+            User user = writableUsers().addUser(id, operation.other, operation.age, operation.location);
+            for (const string &interest : operation.interests)
+            {
+                user.addInterest(interest);
+            }
+            next->graph.addUser(id);
+            break;
+        }
+        case NetworkUpdate::OperationType::AddConnection:
+            if (!next->users->contains(id) || !next->users->contains(operation.other))
+                throw runtime_error("cannot connect unknown users " + id + " and " + operation.other);
+            next->graph.addConnection(id, operation.other);
+            break;
+        case NetworkUpdate::OperationType::RemoveConnection:
+            next->graph.removeConnection(id, operation.other);
+            break;
+        case NetworkUpdate::OperationType::RemoveUser:
+            if (!next->users->contains(id))
+                throw runtime_error("unknown user " + id);
+            writableUsers().removeUser(id);
+            next->graph.removeUser(id);
+            break;
+        }
+    }
+
+    atomic_store(&current, shared_ptr<const NetworkSnapshot>(move(next)));
+    return base->version + 1;
+}
+
+unsigned long long VersionedNetwork::rebuildGraph(const function<void(Graph &)> &rebuild)
+{
+    shared_ptr<const NetworkSnapshot> base = atomic_load(&current);
+    auto next = make_shared<NetworkSnapshot>(*base);
+    rebuild(next->graph);
+
+    lock_guard<mutex> lock(writerMutex);
+    shared_ptr<const NetworkSnapshot> latest = atomic_load(&current);
+    if (latest != base)
+    {
+        next = make_shared<NetworkSnapshot>(*latest);
+        rebuild(next->graph);
+    }
+
+    next->version = latest->version + 1;
+    atomic_store(&current, shared_ptr<const NetworkSnapshot>(move(next)));
+    return latest->version + 1;
+}
+
+unsigned long long VersionedNetwork::compact(VertexOrder order)
+{
+    return rebuildGraph([order](Graph &graph)
+                        { graph.compact(order); });
+}
+
+unsigned long long VersionedNetwork::compressAdjacency()
+{
+    return rebuildGraph([](Graph &graph)
+                        { graph.compressAdjacency(); });
+}
+
+unsigned long long VersionedNetwork::replace(Graph graph, UserStore users)
+{
+    lock_guard<mutex> lock(writerMutex);
+    shared_ptr<const NetworkSnapshot> base = atomic_load(&current);
+
+    auto next = make_shared<NetworkSnapshot>();
+    next->graph = move(graph);
+    next->users = make_shared<const UserStore>(move(users));
+    next->version = base->version + 1;
+
+    atomic_store(&current, shared_ptr<const NetworkSnapshot>(move(next)));
+    return base->version + 1;
+}
@@ -1,12 +1,21 @@
 #include <iostream>
+#include <fstream>
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <filesystem>
 #include <set>
+#include <sstream>
 #include "../include/Graph.hpp"
-#include "../include/User.hpp"
+#include "../include/UserStore.hpp"
 #include "../include/NetworkParser.hpp"
 #include "../include/StringSearch.hpp"
+#include "../include/AutocompleteIndex.hpp"
+#include "../include/FuzzyNameIndex.hpp"
+#include "../include/QueryEngine.hpp"
+#include "../include/CommandRunner.hpp"
+#include "../include/QueryServer.hpp"
+#include <csignal>
 
 using namespace std;
 
@@ -16,13 +25,13 @@ void printDivider()
          << string(60, '-') << "\n";
 }
 
-void printUserList(const vector<User *> &users, const string &title)
+void printUserList(const UserStore &users, const string &title)
 {
     cout << "\n"
          << title << ":\n";
-    for (const User *user : users)
+    for (const ConstUser user : users)
     {
-        cout << user->toString() << "\n";
+        cout << user.toString() << "\n";
     }
 }
 
@@ -117,15 +126,36 @@ int getIntInput(const string &prompt, int min = numeric_limits<int>::min(), int
     }
 }
 
-void addNewUser(Graph &socialNetwork, vector<User *> &users)
+// Indexes over the loaded users, each built on first use and kept until users are added
+// or removed, since they refer to store rows
+struct SearchIndexes
+{
+    unique_ptr<FuzzyNameIndex> fuzzyNames;
+    unique_ptr<AutocompleteIndex> autocomplete;
+    unique_ptr<QueryEngine> queryEngine;
+
+    void invalidate()
+    {
+        fuzzyNames.reset();
+        autocomplete.reset();
+        queryEngine.reset();
+    }
+};
+
+void addNewUser(Graph &socialNetwork, UserStore &users, SearchIndexes &indexes)
 {
     cout << "\n=== Add New User ===\n";
     string id = getInput("Enter user ID: ");
+    if (users.contains(id))
+    {
+        cout << "A user with this ID already exists!\n";
+        return;
+    }
     string name = getInput("Enter name: ");
     int age = getIntInput("Enter age (1-120): ", 1, 120);
     string location = getInput("Enter location: ");
 
-    User *user = new User(id, name, age, location);
+    User user = users.addUser(id, name, age, location);
 
     cout << "Add interests? (y/n): ";
     string answer;
@@ -136,24 +166,24 @@ void addNewUser(Graph &socialNetwork, vector<User *> &users)
         string interest = getInput("Enter an interest (or press Enter to finish): ");
         if (interest.empty())
             break;
-        user->addInterest(interest);
+        user.addInterest(interest);
 
         cout << "Add another interest? (y/n): ";
         getline(cin, answer);
     }
 
-    users.push_back(user);
     socialNetwork.addUser(id);
+    indexes.invalidate();
     cout << "\nUser added successfully!\n";
 }
 
-void addConnection(Graph &socialNetwork, const vector<User *> &users)
+void addConnection(Graph &socialNetwork, const UserStore &users)
 {
     cout << "\n=== Add Connections ===\n";
     cout << "\nAvailable users:\n";
-    for (const User *user : users)
+    for (const ConstUser user : users)
     {
-        cout << user->getUserId() << " - " << user->getName() << "\n";
+        cout << user.getUserId() << " - " << user.getName() << "\n";
     }
 
     vector<pair<string, string>> connections;
@@ -164,16 +194,7 @@ void addConnection(Graph &socialNetwork, const vector<User *> &users)
         string user1 = getInput("\nEnter first user ID: ");
         string user2 = getInput("Enter second user ID: ");
 
-        bool user1Found = false, user2Found = false;
-        for (const User *user : users)
-        {
-            if (user->getUserId() == user1)
-                user1Found = true;
-            if (user->getUserId() == user2)
-                user2Found = true;
-        }
-
-        if (!user1Found || !user2Found)
+        if (!users.contains(user1) || !users.contains(user2))
         {
             cout << "One or both users not found!\n";
         }
@@ -197,29 +218,236 @@ void addConnection(Graph &socialNetwork, const vector<User *> &users)
          << connections.size() << " connection(s) added successfully!\n";
 }
 
-void searchUsers(const vector<User *> &users)
+void removeUser(Graph &socialNetwork, UserStore &users, SearchIndexes &indexes)
+{
+    cout << "\n=== Remove User ===\n";
+    string userId = getInput("Enter user ID to remove: ");
+
+    if (!users.removeUser(userId))
+    {
+        cout << "User not found!\n";
+        return;
+    }
+    socialNetwork.removeUser(userId);
+    indexes.invalidate();
+    cout << "User " << userId << " removed along with their connections.\n";
+}
+
+void searchUsersByInterests(const UserStore &users)
+{
+    string input = getInput("Enter interests (comma-separated): ");
+
+    vector<string> patterns;
+    stringstream ss(input);
+    string pattern;
+    while (getline(ss, pattern, ','))
+    {
+        size_t first = pattern.find_first_not_of(' ');
+        size_t last = pattern.find_last_not_of(' ');
+        if (first != string::npos)
+        {
+            patterns.push_back(pattern.substr(first, last - first + 1));
+        }
+    }
+
+    cout << "\nSearch Results:\n";
+    auto results = StringSearch::searchUsersByInterests(users, patterns);
+
+    if (results.empty())
+    {
+        cout << "No matching users found.\n";
+        return;
+    }
+
+    for (const auto &match : results)
+    {
+        cout << "\n"
+             << match.user.toString() << "Matched: ";
+        for (size_t i = 0; i < match.patternIds.size(); ++i)
+        {
+            cout << patterns[match.patternIds[i]];
+            if (i < match.patternIds.size() - 1)
+                cout << ", ";
+        }
+        cout << "\n";
+    }
+}
+
+void fuzzySearchUsers(const UserStore &users, SearchIndexes &indexes)
+{
+    string searchTerm = getInput("Enter name (typos allowed): ");
+    int maxDistance = getIntInput("Maximum number of typos (0-3): ", 0, 3);
+
+    cout << "\nSearch Results:\n";
+    if (!indexes.fuzzyNames)
+        indexes.fuzzyNames = make_unique<FuzzyNameIndex>(users);
+    auto results = indexes.fuzzyNames->search(searchTerm, maxDistance);
+
+    if (results.empty())
+    {
+        cout << "No matching users found.\n";
+        return;
+    }
+
+    for (const auto &match : results)
+    {
+        cout << "\n"
+             << match.user.toString() << "Typos: " << match.distance << "\n";
+    }
+}
+
+void autocompleteUsers(const Graph &socialNetwork, const UserStore &users, SearchIndexes &indexes)
+{
+    string prefix = getInput("Enter the beginning of a name: ");
+
+    if (!indexes.autocomplete)
+        indexes.autocomplete = make_unique<AutocompleteIndex>(users, socialNetwork);
+    vector<ConstUser> results = indexes.autocomplete->complete(prefix, 10, socialNetwork);
+
+    cout << "\nSuggestions:\n";
+    if (results.empty())
+    {
+        cout << "No matching users found.\n";
+        return;
+    }
+
+    for (const ConstUser &user : results)
+    {
+        cout << "- " << user.getName() << " (" << user.getUserId() << ", "
+             << socialNetwork.getDegree(string(user.getUserId())) << " connections)\n";
+    }
+}
+
+void filterUsers(const UserStore &users, SearchIndexes &indexes)
+{
+    cout << "\n=== Filter Users ===\n";
+    UserQuery query;
+    query.minAge = getIntInput("Minimum age (0 for any): ", 0, 120);
+    query.maxAge = getIntInput("Maximum age (0 for any): ", 0, 120);
+    if (query.minAge == 0)
+        query.minAge = numeric_limits<int>::min();
+    if (query.maxAge == 0)
+        query.maxAge = numeric_limits<int>::max();
+    query.location = getInput("Location (press Enter for any): ");
+
+    stringstream ss(getInput("Required interests (comma-separated, press Enter for none): "));
+    string interest;
+    while (getline(ss, interest, ','))
+    {
+        size_t first = interest.find_first_not_of(' ');
+        size_t last = interest.find_last_not_of(' ');
+        if (first != string::npos)
+        {
+            query.interests.push_back(interest.substr(first, last - first + 1));
+        }
+    }
+
+    if (!indexes.queryEngine)
+        indexes.queryEngine = make_unique<QueryEngine>(users);
+    cout << "\nQuery plan:\n"
+         << indexes.queryEngine->explain(query);
+
+    vector<ConstUser> results = indexes.queryEngine->search(query);
+    cout << "\nResults (" << results.size() << "):\n";
+    if (results.empty())
+    {
+        cout << "No matching users found.\n";
+        return;
+    }
+
+    for (const ConstUser &user : results)
+    {
+        cout << "\n"
+             << user.toString();
+    }
+}
+
+void searchNearUser(const Graph &socialNetwork, const UserStore &users)
+{
+    string sourceId = getInput("Enter user ID to search around: ");
+    if (!users.contains(sourceId))
+    {
+        cout << "User not found!\n";
+        return;
+    }
+
+    int maxHops = getIntInput("Maximum number of hops (1-6): ", 1, 6);
+    cout << "1. Name\n2. Location\n3. Interest\n";
+    int fieldChoice = getIntInput("Field to search (1-3): ", 1, 3);
+    string searchTerm = getInput("Enter search term: ");
+    int limit = getIntInput("Maximum number of results (0 for all): ", 0);
+
+    SearchField field = fieldChoice == 1 ? SearchField::NAME : fieldChoice == 2 ? SearchField::LOCATION
+                                                                                : SearchField::INTEREST;
+    auto results = StringSearch::searchNeighbourhood(socialNetwork, users, sourceId, maxHops, field, searchTerm, limit);
+
+    cout << "\nSearch Results:\n";
+    if (results.empty())
+    {
+        cout << "No matching users found.\n";
+        return;
+    }
+
+    for (const auto &match : results)
+    {
+        cout << "\n"
+             << match.user.toString() << "Hops away: " << match.hops << "\n";
+    }
+}
+
+void searchUsers(const Graph &socialNetwork, const UserStore &users, SearchIndexes &indexes)
 {
     cout << "\n=== Search Users ===\n";
     cout << "1. Search by name\n";
     cout << "2. Search by location\n";
     cout << "3. Search by interest\n";
+    cout << "4. Search by several interests\n";
+    cout << "5. Fuzzy search by name\n";
+    cout << "6. Autocomplete name\n";
+    cout << "7. Search near a user\n";
+
+    int choice = getIntInput("Enter your choice (1-7): ", 1, 7);
+
+    if (choice == 4)
+    {
+        searchUsersByInterests(users);
+        return;
+    }
+    if (choice == 5)
+    {
+        fuzzySearchUsers(users, indexes);
+        return;
+    }
+    if (choice == 6)
+    {
+        autocompleteUsers(socialNetwork, users, indexes);
+        return;
+    }
+    if (choice == 7)
+    {
+        searchNearUser(socialNetwork, users);
+        return;
+    }
 
-    int choice = getIntInput("Enter your choice (1-3): ", 1, 3);
     string searchTerm = getInput("Enter search term: ");
 
+    cout << "1. KMP\n2. Rabin-Karp\n3. Vectorized (" << StringSearch::getSIMDKernelName() << ")\n";
+    const SearchAlgorithm algorithms[] = {SearchAlgorithm::KMP, SearchAlgorithm::RABIN_KARP, SearchAlgorithm::SIMD};
+    SearchAlgorithm algorithm = algorithms[getIntInput("Choose the matching algorithm (1-3): ", 1, 3) - 1];
+
     cout << "\nSearch Results:\n";
-    vector<User *> results;
+    vector<ConstUser> results;
 
     switch (choice)
     {
     case 1:
-        results = StringSearch::searchUsersByName(users, searchTerm, true);
+        results = StringSearch::parallelSearchUsers(users, SearchField::NAME, searchTerm, algorithm);
         break;
     case 2:
-        results = StringSearch::searchUsersByLocation(users, searchTerm, false);
+        results = StringSearch::parallelSearchUsers(users, SearchField::LOCATION, searchTerm, algorithm);
         break;
     case 3:
-        results = StringSearch::searchUsersByInterest(users, searchTerm, true);
+        results = StringSearch::parallelSearchUsers(users, SearchField::INTEREST, searchTerm, algorithm);
         break;
     }
 
@@ -229,10 +457,10 @@ void searchUsers(const vector<User *> &users)
     }
     else
     {
-        for (const User *user : results)
+        for (const ConstUser &user : results)
         {
             cout << "\n"
-                 << user->toString();
+                 << user.toString();
         }
     }
 }
@@ -247,10 +475,12 @@ void showMainMenu()
     cout << "5. Show communities\n";
     cout << "6. Show shortest paths\n";
     cout << "7. Search users\n";
+    cout << "8. Filter users by attributes\n";
+    cout << "9. Remove user\n";
     cout << "0. Exit\n";
 }
 
-void loadNetworkData(Graph &socialNetwork, vector<User *> &users)
+void loadNetworkData(Graph &socialNetwork, UserStore &users)
 {
     try
     {
@@ -279,7 +509,7 @@ void loadNetworkData(Graph &socialNetwork, vector<User *> &users)
     }
 }
 
-void saveNetworkData(const Graph &socialNetwork, const vector<User *> &users)
+void saveNetworkData(const Graph &socialNetwork, const UserStore &users)
 {
     filesystem::path dataPath = filesystem::current_path() / "data" / "Network.json";
     cout << "\nSaving network data to: " << dataPath << endl;
@@ -294,10 +524,190 @@ void saveNetworkData(const Graph &socialNetwork, const vector<User *> &users)
     }
 }
 
-int main()
+void printUsage(const char *program)
+{
+    cerr << "Usage: " << program << " [options]\n"
+         << "Without options the interactive menu is started. Options run in order, printing\n"
+         << "one JSON line per result:\n"
+         << "  --load <file>               Load a network (default: data/Network.json)\n"
+         << "  --query <command> [args]    Run a command, e.g. --query recommend user1\n"
+         << "  --reorder <bfs|degree|rcm>  Renumber users for traversal locality\n"
+         << "  --communities               Detect communities\n"
+         << "  --search <field> <pattern>  Search by name, location or interest; the field may\n"
+         << "                              end in :kmp, :rabin-karp or :simd\n"
+         << "  --export <file>             Save the network (.csv for CSV, JSON otherwise)\n"
+         << "  --commands <file>           Run one command per line from a file (- for stdin)\n"
+         << "  --serve <socket>            After the other options, answer JSON requests on a\n"
+         << "                              Unix socket until interrupted\n";
+}
+
+// Non-interactive mode: options are turned into commands and run against one loaded
+// network. Parser diagnostics on cout are silenced so stdout carries only results.
+int runBatch(int argc, char *argv[])
+{
+    struct Step
+    {
+        vector<string> words;
+        string scriptFile; // Set for --commands
+    };
+
+    vector<Step> steps;
+    bool loadGiven = false;
+    string socketPath;
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        auto needs = [&](int count)
+        {
+            if (i + count >= argc)
+                throw invalid_argument(option + " needs " + to_string(count) + " argument(s)");
+        };
+
+        if (option == "--load" || option == "--export")
+        {
+            needs(1);
+            steps.push_back({{option.substr(2), argv[++i]}, ""});
+            loadGiven = loadGiven || option == "--load";
+        }
+        else if (option == "--query")
+        {
+            needs(1);
+            Step step;
+            while (i + 1 < argc && string(argv[i + 1]).compare(0, 2, "--") != 0)
+            {
+                step.words.push_back(argv[++i]);
+            }
+            if (step.words.empty())
+                throw invalid_argument("--query needs a command");
+            steps.push_back(step);
+        }
+        else if (option == "--reorder")
+        {
+            needs(1);
+            steps.push_back({{"reorder", argv[++i]}, ""});
+        }
+        else if (option == "--communities")
+        {
+            steps.push_back({{"communities"}, ""});
+        }
+        else if (option == "--search")
+        {
+            needs(2);
+            steps.push_back({{"search", argv[i + 1], argv[i + 2]}, ""});
+            i += 2;
+        }
+        else if (option == "--commands")
+        {
+            needs(1);
+            steps.push_back({{}, argv[++i]});
+        }
+        else if (option == "--serve")
+        {
+            needs(1);
+            socketPath = argv[++i];
+        }
+        else
+        {
+            throw invalid_argument("unknown option " + option);
+        }
+    }
+
+    if (!loadGiven)
+    {
+        string defaultPath = (filesystem::current_path() / "data" / "Network.json").string();
+        steps.insert(steps.begin(), {{"load", defaultPath}, ""});
+    }
+
+    // Results are the only thing batch mode writes to stdout
+    NetworkParser::setVerbose(false);
+    ostream &out = cout;
+
+    VersionedNetwork network;
+    CommandRunner runner(network);
+    size_t failures = 0;
+
+    for (const Step &step : steps)
+    {
+        if (!step.scriptFile.empty())
+        {
+            if (step.scriptFile == "-")
+            {
+                failures += runner.runScript(cin, out);
+                continue;
+            }
+
+            ifstream script(step.scriptFile);
+            if (!script.is_open())
+            {
+                cerr << "Error: could not open " << step.scriptFile << "\n";
+                failures++;
+                continue;
+            }
+            failures += runner.runScript(script, out);
+            continue;
+        }
+
+        bool succeeded;
+        out << runner.run(step.words, &succeeded) << "\n"
+            << flush;
+        if (!succeeded)
+        {
+            failures++;
+            // Nothing after a failed load has a network to work on
+            if (step.words[0] == "load")
+                break;
+        }
+    }
+
+    if (!socketPath.empty() && failures == 0)
+    {
+        signal(SIGINT, [](int)
+               { QueryServer::requestStop(); });
+        signal(SIGTERM, [](int)
+               { QueryServer::requestStop(); });
+
+        try
+        {
+            QueryServer server(runner, socketPath, max(4u, thread::hardware_concurrency()));
+            cerr << "Serving " << network.snapshot()->users->size() << " users on " << socketPath << "\n";
+            server.run();
+        }
+        catch (const exception &e)
+        {
+            cerr << "Error: " << e.what() << "\n";
+            failures++;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
 {
+    if (argc > 1)
+    {
+        string first = argv[1];
+        if (first == "--help" || first == "-h")
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+
+        try
+        {
+            return runBatch(argc, argv);
+        }
+        catch (const invalid_argument &e)
+        {
+            cerr << "Error: " << e.what() << "\n";
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
     Graph socialNetwork;
-    vector<User *> users;
+    UserStore users;
+    SearchIndexes indexes;
 
     // Automatically load data at startup
     loadNetworkData(socialNetwork, users);
@@ -307,7 +717,7 @@ int main()
         clearScreen();
         showMainMenu();
 
-        int choice = getIntInput("\nEnter your choice (0-7): ", 0, 7);
+        int choice = getIntInput("\nEnter your choice (0-9): ", 0, 9);
 
         if (choice == 0)
         {
@@ -319,7 +729,7 @@ int main()
         switch (choice)
         {
         case 1:
-            addNewUser(socialNetwork, users);
+            addNewUser(socialNetwork, users, indexes);
             break;
 
         case 2:
@@ -334,22 +744,23 @@ int main()
         case 4:
             printDivider();
             cout << "\nFriend Recommendations:\n";
-            for (const User *user : users)
+            for (const ConstUser user : users)
             {
-                cout << "\nRecommendations for " << user->getName() << ":\n";
-                auto recommendations = socialNetwork.getFriendRecommendations(user->getUserId());
+                cout << "\nRecommendations for " << user.getName() << ":\n";
+                auto recommendations = socialNetwork.getTopRecommendations(string(user.getUserId()));
                 for (const auto &recommendedId : recommendations)
                 {
-                    for (const User *u : users)
+                    size_t row = users.findRow(recommendedId);
+                    if (row != UserStore::NOT_FOUND)
                     {
-                        if (u->getUserId() == recommendedId)
-                        {
-                            cout << "- " << u->getName() << "\n";
-                            break;
-                        }
+                        cout << "- " << users[row].getName() << "\n";
                     }
                 }
             }
+            {
+                RecommendationCacheStats stats = socialNetwork.getRecommendationCacheStats();
+                cout << "\n(Recommendation cache: " << stats.hits << " hits, " << stats.misses << " misses)\n";
+            }
             break;
 
         case 5:
@@ -363,19 +774,20 @@ int main()
             break;
 
         case 7:
-            searchUsers(users);
+            searchUsers(socialNetwork, users, indexes);
+            break;
+
+        case 8:
+            filterUsers(users, indexes);
+            break;
+
+        case 9:
+            removeUser(socialNetwork, users, indexes);
             break;
         }
 
         waitForEnter();
     }
 
-    // Clean up
-    for (User *user : users)
-    {
-        delete user;
-    }
-    users.clear();
-
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,233 @@
+// Times the analytics behind the figures quoted in the commit history. Built with -O2
+// against the project sources by `make tools`, and run on the network from
+// `make bench-network`:
+//
+//   build/tools/benchmark build/network-200k.json [section...]
+//
+// Every section runs when none is named. Each works on its own copy of the loaded graph.
+
+#include "../include/GraphMetrics.hpp"
+#include "../include/NetworkParser.hpp"
+#include "../include/RandomWalk.hpp"
+#include "../include/StringSearch.hpp"
+#include "../include/ThreadPool.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// PageRank to convergence and sampled betweenness, in RCM order
+static void benchmarkCentrality(const Graph &network, const UserStore &)
+{
+    Graph graph = network;
+    graph.compact(VertexOrder::REVERSE_CUTHILL_MCKEE);
+
+    int iterations = 0;
+    auto start = Clock::now();
+    GraphMetrics::pageRank(graph, 0.85, 1e-6, 100, &iterations);
+    cout << "pagerank: " << elapsedMs(start) << " ms, " << iterations << " iterations\n";
+
+    const size_t samples = 64;
+    start = Clock::now();
+    GraphMetrics::betweenness(graph, samples);
+    cout << "betweenness: " << elapsedMs(start) / samples << " ms per source (" << samples << " sources)\n";
+}
+
+// Sequential bucket peeling against level-synchronous parallel peeling, in file order
+static void benchmarkCoreness(const Graph &graph, const UserStore &)
+{
+    auto start = Clock::now();
+    vector<int> cores = GraphMetrics::coreNumbers(graph);
+    cout << "core numbers (bucket): " << elapsedMs(start) << " ms\n";
+
+    start = Clock::now();
+    vector<int> parallelCores = GraphMetrics::coreNumbersParallel(graph);
+    cout << "core numbers (parallel): " << elapsedMs(start) << " ms, "
+         << (parallelCores == cores ? "same" : "DIFFERENT") << " result\n";
+}
+
+// Ego networks of one user, all-pairs distances inside one, and k-core extraction
+static void benchmarkSubgraph(const Graph &graph, const UserStore &)
+{
+    const string center = graph.getUserId(12345);
+    for (int hops = 1; hops <= 2; hops++)
+    {
+        auto start = Clock::now();
+        Graph ego = graph.egoNetwork(center, hops);
+        double egoMs = elapsedMs(start);
+        cout << hops << "-hop ego network: " << ego.getUserCount() << " users, " << ego.getConnectionCount()
+             << " connections, " << egoMs << " ms\n";
+
+        start = Clock::now();
+        ego.floydWarshall();
+        cout << "  floyd-warshall on it: " << elapsedMs(start) << " ms\n";
+    }
+
+    auto start = Clock::now();
+    Graph core = GraphMetrics::kCore(graph, GraphMetrics::coreNumbers(graph), 3);
+    cout << "3-core extraction, with core numbers: " << core.getUserCount() << " users, " << elapsedMs(start)
+         << " ms\n";
+}
+
+// Random-walk engine construction and Personalized PageRank queries. The benchmark
+// network has no interests, so a synthetic weight stands in for the shared-interest one
+// of the ppr command and every neighbour list gets a non-trivial alias table.
+static void benchmarkPersonalizedPageRank(const Graph &graph, const UserStore &)
+{
+    auto start = Clock::now();
+    RandomWalkEngine engine(graph, [](int a, int b)
+                            { return 1.0 + ((a ^ b) & 3); });
+    cout << "walk engine: " << elapsedMs(start) << " ms, " << engine.getBytesUsed() / 1e6 << " MB\n";
+
+    for (size_t walks : {10000, 100000})
+    {
+        start = Clock::now();
+        engine.recommend(12345, 10, walks);
+        cout << "ppr, " << walks << " walks: " << elapsedMs(start) << " ms\n";
+    }
+}
+
+// Cached top-k recommendations for 1000 users spread over the vertex numbers: the BFS
+// list they replace, misses, hits, invalidation around a new connection, then warming
+// every user
+static void benchmarkRecommendations(const Graph &network, const UserStore &)
+{
+    Graph graph = network;
+    vector<string> ids;
+    for (int i = 0; i < 1000; i++)
+    {
+        ids.push_back(graph.getUserId(i * 199));
+    }
+    auto perLookupUs = [&](Clock::time_point start)
+    {
+        return elapsedMs(start) * 1000 / ids.size();
+    };
+
+    auto start = Clock::now();
+    for (const string &id : ids)
+    {
+        graph.getFriendRecommendations(id);
+    }
+    cout << "bfs recommendations: " << perLookupUs(start) << " us each\n";
+
+    start = Clock::now();
+    for (const string &id : ids)
+    {
+        graph.getTopRecommendations(id);
+    }
+    cout << "cache miss: " << perLookupUs(start) << " us each\n";
+
+    start = Clock::now();
+    for (const string &id : ids)
+    {
+        graph.getTopRecommendations(id);
+    }
+    cout << "cache hit: " << perLookupUs(start) << " us each\n";
+
+    start = Clock::now();
+    graph.addConnection(ids[0], ids[1]);
+    cout << "connection with invalidation: " << elapsedMs(start) * 1000 << " us, "
+         << graph.getRecommendationCacheStats().invalidations << " entries dropped\n";
+
+    start = Clock::now();
+    graph.warmRecommendationCache();
+    cout << "warming every user: " << elapsedMs(start) << " ms\n";
+}
+
+// Name search with each matching algorithm, over the user store and over every name
+// joined into one text, where the vector kernel's long blocks dominate
+static void benchmarkStringSearch(const Graph &, const UserStore &users)
+{
+    const pair<const char *, SearchAlgorithm> algorithms[] = {
+        {"kmp", SearchAlgorithm::KMP},
+        {"rabin-karp", SearchAlgorithm::RABIN_KARP},
+        {"simd", SearchAlgorithm::SIMD},
+    };
+    string text;
+    for (string_view name : users.getNames())
+    {
+        text.append(name.data(), name.size());
+        text += ' ';
+    }
+    cout << "simd kernel: " << StringSearch::getSIMDKernelName() << ", joined names: " << text.size() / 1e6 << " MB\n";
+
+    StringSearch::Pattern pattern("n12345");
+    for (const auto &[name, algorithm] : algorithms)
+    {
+        auto start = Clock::now();
+        size_t found = StringSearch::parallelSearchUsers(users, SearchField::NAME, "n12345", algorithm).size();
+        double usersMs = elapsedMs(start);
+
+        start = Clock::now();
+        size_t matches = pattern.findAll(text, algorithm).size();
+        cout << name << ": " << usersMs << " ms over users (" << found << " found), " << elapsedMs(start)
+             << " ms over the joined text (" << matches << " matches)\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const map<string, function<void(const Graph &, const UserStore &)>> sections = {
+        {"centrality", benchmarkCentrality},
+        {"coreness", benchmarkCoreness},
+        {"ppr", benchmarkPersonalizedPageRank},
+        {"recommendations", benchmarkRecommendations},
+        {"search", benchmarkStringSearch},
+        {"subgraph", benchmarkSubgraph},
+    };
+
+    if (argc < 2)
+    {
+        cerr << "usage: " << argv[0] << " <network.json> [section...]\nsections:";
+        for (const auto &section : sections)
+        {
+            cerr << ' ' << section.first;
+        }
+        cerr << '\n';
+        return 2;
+    }
+
+    vector<string> selected(argv + 2, argv + argc);
+    if (selected.empty())
+    {
+        for (const auto &section : sections)
+        {
+            selected.push_back(section.first);
+        }
+    }
+    for (const string &name : selected)
+    {
+        if (!sections.count(name))
+        {
+            cerr << "unknown section " << name << '\n';
+            return 2;
+        }
+    }
+
+    Graph graph;
+    UserStore users;
+    NetworkParser::setVerbose(false);
+    if (!NetworkParser::parseJSONFile(argv[1], graph, users))
+    {
+        cerr << "could not load " << argv[1] << '\n';
+        return 1;
+    }
+    cout << argv[1] << ": " << graph.getUserCount() << " users, " << graph.getConnectionCount()
+         << " connections, " << ThreadPool::shared().getThreadCount() << " threads\n";
+
+    for (const string &name : selected)
+    {
+        cout << "[" << name << "]\n";
+        sections.at(name)(graph, users);
+    }
+    return 0;
+}
@@ -0,0 +1,1474 @@
+// Randomized checks of the graph algorithms and user indexes against naive reference
+// implementations, on small graphs with removed users and, in some rounds, compressed
+// adjacency. Built by
+// `make tools` and run by `make check`:
+//
+//   build/tools/check [section...]
+//
+// Every section runs when none is named. Exits with status 1 when any check fails.
+
+#include "../include/FuzzyNameIndex.hpp"
+#include "../include/GraphMetrics.hpp"
+#include "../include/QueryEngine.hpp"
+#include "../include/RandomWalk.hpp"
+#include "../include/VersionedNetwork.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+static string userId(int user)
+{
+    return "u" + to_string(user);
+}
+
+// A graph over users u0..u(n-1) together with the same connections as plain sets
+struct RandomGraph
+{
+    Graph graph;
+    vector<set<int>> adjacency; // By user number
+    vector<char> removed;
+
+    int vertexOf(int user) const { return graph.getUserIndex(userId(user)); }
+};
+
+// Connects random pairs, a third of them to the first tenth of the users so degrees are
+// skewed, then removes up to one user in eight
+static RandomGraph buildRandomGraph(mt19937 &rng, int n, int connections)
+{
+    RandomGraph result;
+    result.adjacency.resize(n);
+    result.removed.assign(n, 0);
+    for (int user = 0; user < n; user++)
+    {
+        result.graph.addUser(userId(user));
+    }
+    for (int i = 0; i < connections; i++)
+    {
+        int a = rng() % n;
+        int b = rng() % 3 ? rng() % n : rng() % (n / 10 + 1);
+        if (a == b)
+            continue;
+        result.graph.addConnection(userId(a), userId(b));
+        result.adjacency[a].insert(b);
+        result.adjacency[b].insert(a);
+    }
+    for (int i = 0; i < n / 8; i++)
+    {
+        int user = rng() % n;
+        if (result.removed[user])
+            continue;
+        result.removed[user] = 1;
+        result.graph.removeUser(userId(user));
+        for (int neighbor : result.adjacency[user])
+        {
+            result.adjacency[neighbor].erase(user);
+        }
+        result.adjacency[user].clear();
+    }
+    return result;
+}
+
+// Core numbers by definition: the k-core is what remains after repeatedly deleting
+// users with fewer than k neighbours left
+static vector<int> naiveCoreNumbers(const RandomGraph &random)
+{
+    int n = random.adjacency.size();
+    vector<int> cores(n, -1);
+    for (int k = 0;; k++)
+    {
+        vector<char> inCore(n);
+        for (int user = 0; user < n; user++)
+        {
+            inCore[user] = !random.removed[user];
+        }
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int user = 0; user < n; user++)
+            {
+                if (!inCore[user])
+                    continue;
+                int degree = 0;
+                for (int neighbor : random.adjacency[user])
+                {
+                    degree += inCore[neighbor];
+                }
+                if (degree < k)
+                {
+                    inCore[user] = 0;
+                    changed = true;
+                }
+            }
+        }
+
+        int remaining = 0;
+        for (int user = 0; user < n; user++)
+        {
+            if (inCore[user])
+            {
+                cores[user] = k;
+                remaining++;
+            }
+        }
+        if (remaining == 0)
+            return cores;
+    }
+}
+
+// Both core number algorithms against naive peeling, and the size of the extracted k-core
+static size_t checkCoreness()
+{
+    mt19937 rng(13);
+    size_t failures = 0;
+    for (int round = 0; round < 60; round++)
+    {
+        int n = 2 + rng() % (round < 30 ? 30 : 600);
+        RandomGraph random = buildRandomGraph(rng, n, rng() % (n * (1 + round % 8)));
+        if (round % 3 == 1)
+            random.graph.compressAdjacency();
+
+        vector<int> expected = naiveCoreNumbers(random);
+        vector<int> cores = GraphMetrics::coreNumbers(random.graph);
+        failures += cores != GraphMetrics::coreNumbersParallel(random.graph);
+        for (int user = 0; user < n; user++)
+        {
+            if (!random.removed[user])
+                failures += cores[random.vertexOf(user)] != expected[user];
+        }
+
+        int k = rng() % 4;
+        Graph core = GraphMetrics::kCore(random.graph, cores, k);
+        int users = 0;
+        size_t connections = 0;
+        for (int user = 0; user < n; user++)
+        {
+            if (random.removed[user] || expected[user] < k)
+                continue;
+            users++;
+            for (int neighbor : random.adjacency[user])
+            {
+                connections += neighbor > user && expected[neighbor] >= k;
+            }
+        }
+        failures += core.getUserCount() != users || core.getConnectionCount() != connections;
+    }
+    return failures;
+}
+
+// Neighbours of each user by user number, read back from the graph
+static size_t compareAdjacency(const RandomGraph &random)
+{
+    size_t failures = 0;
+    for (int user = 0; user < (int)random.adjacency.size(); user++)
+    {
+        if (random.removed[user])
+            continue;
+        set<int> neighbors;
+        for (int neighbor : random.graph.getNeighbors(random.vertexOf(user)))
+        {
+            const string &id = random.graph.getUserId(neighbor);
+            if (!random.graph.isRemoved(neighbor))
+                neighbors.insert(id.size() > 1 ? stoi(id.substr(1)) : -1);
+        }
+        failures += neighbors != random.adjacency[user];
+    }
+    return failures;
+}
+
+// Packed lists against the sorted plain ones, with first neighbours on both sides of
+// their vertex and gaps from one to three varint bytes, then graphs compressed, changed
+// (which expands them) and compressed again
+static size_t checkCompressedAdjacency()
+{
+    mt19937 rng(43);
+    size_t failures = 0;
+    CompressedAdjacency packed; // Reused, so every build starts from the previous one
+    for (int round = 0; round < 200; round++)
+    {
+        int n = 1 + rng() % (round % 10 == 0 ? 70000 : 300);
+        vector<char> removed(n);
+        vector<set<int>> expected(n);
+        ChunkedVector<vector<int>> lists;
+        for (int vertex = 0; vertex < n; vertex++)
+        {
+            removed[vertex] = rng() % 8 == 0;
+            set<int> list;
+            for (int i = rng() % (rng() % 20 ? 6 : 200); i > 0; i--)
+            {
+                int spread = rng() % 3 == 0 ? n : 1 + rng() % 200;
+                int neighbor = vertex + (int)(rng() % (2 * spread + 1)) - spread;
+                if (neighbor >= 0 && neighbor < n)
+                    list.insert(neighbor);
+            }
+            vector<int> shuffled(list.begin(), list.end());
+            shuffle(shuffled.begin(), shuffled.end(), rng);
+            lists.push_back(shuffled);
+            expected[vertex] = list;
+        }
+        for (int vertex = 0; vertex < n; vertex++)
+        {
+            for (auto it = expected[vertex].begin(); it != expected[vertex].end();)
+            {
+                it = removed[vertex] || removed[*it] ? expected[vertex].erase(it) : next(it);
+            }
+        }
+
+        packed.build(lists, removed);
+        failures += packed.getVertexCount() != (size_t)n;
+        for (int vertex = 0; vertex < n; vertex++)
+        {
+            vector<int> decoded;
+            for (int neighbor : packed.neighbors(vertex))
+            {
+                decoded.push_back(neighbor);
+            }
+            failures += packed.degree(vertex) != expected[vertex].size();
+            failures += decoded != vector<int>(expected[vertex].begin(), expected[vertex].end());
+            int probe = rng() % n;
+            failures += packed.contains(vertex, probe) != (expected[vertex].count(probe) != 0);
+        }
+    }
+
+    for (int round = 0; round < 40; round++)
+    {
+        int n = 2 + rng() % 600;
+        RandomGraph random = buildRandomGraph(rng, n, rng() % (n * 6));
+        random.graph.compressAdjacency();
+        failures += !random.graph.isCompressed() || compareAdjacency(random);
+
+        for (int i = 0; i < 20; i++)
+        {
+            int a = rng() % n, b = rng() % n;
+            failures += random.graph.areConnected(userId(a), userId(b)) != (random.adjacency[a].count(b) != 0);
+            if (a == b || random.removed[a] || random.removed[b])
+                continue;
+            if (rng() % 2)
+            {
+                random.graph.addConnection(userId(a), userId(b));
+                random.adjacency[a].insert(b);
+                random.adjacency[b].insert(a);
+            }
+            else
+            {
+                random.graph.removeConnection(userId(a), userId(b));
+                random.adjacency[a].erase(b);
+                random.adjacency[b].erase(a);
+            }
+        }
+        failures += compareAdjacency(random);
+        random.graph.compressAdjacency();
+        failures += compareAdjacency(random);
+    }
+    return failures;
+}
+
+// Triangles through every vertex, clustering and transitivity by testing every pair of
+// neighbours, on dense and sparse graphs with removed users and hubs
+static size_t checkTriangles()
+{
+    mt19937 rng(47);
+    size_t failures = 0;
+    auto near = [](double a, double b)
+    { return fabs(a - b) <= 1e-9 * max(1.0, fabs(b)); };
+    for (int round = 0; round < 60; round++)
+    {
+        int n = 1 + rng() % (round < 30 ? 40 : 500);
+        RandomGraph random = buildRandomGraph(rng, n, rng() % (n * (round % 2 ? 2 : 12) + 1));
+        if (round % 3 == 1)
+            random.graph.compressAdjacency();
+
+        TriangleCounts counts = GraphMetrics::countTriangles(random.graph);
+        unsigned long long total = 0;
+        double clusteringSum = 0, triples = 0;
+        int live = 0;
+        for (int user = 0; user < n; user++)
+        {
+            if (random.removed[user])
+                continue;
+            const set<int> &neighbors = random.adjacency[user];
+            unsigned long long triangles = 0;
+            for (int a : neighbors)
+            {
+                for (int b : neighbors)
+                {
+                    triangles += a < b && random.adjacency[a].count(b);
+                }
+            }
+            double pairs = neighbors.size() * (neighbors.size() - 1.0) / 2;
+            double clustering = pairs > 0 ? triangles / pairs : 0;
+            int vertex = random.vertexOf(user);
+            failures += counts.perVertex[vertex] != triangles || !near(counts.clustering[vertex], clustering);
+            total += triangles;
+            clusteringSum += clustering;
+            triples += pairs;
+            live++;
+        }
+        failures += counts.total * 3 != total;
+        failures += !near(counts.averageClustering, live ? clusteringSum / live : 0);
+        failures += !near(counts.transitivity, triples > 0 ? total / triples : 0);
+        for (int vertex = 0; vertex < random.graph.getVertexCount(); vertex++)
+        {
+            if (random.graph.isRemoved(vertex))
+                failures += counts.perVertex[vertex] != 0 || counts.clustering[vertex] != 0;
+        }
+    }
+    return failures;
+}
+
+// Betweenness from all-pairs BFS with shortest-path counts, summing each pair's share
+// through every user; PageRank, closeness and degree centrality straight from their
+// definitions; and the top-k ordering
+static size_t checkCentrality()
+{
+    mt19937 rng(53);
+    size_t failures = 0;
+    auto near = [](double a, double b, double tolerance)
+    { return fabs(a - b) <= tolerance * max(1.0, fabs(b)); };
+    for (int round = 0; round < 40; round++)
+    {
+        int n = 1 + rng() % (round < 20 ? 20 : 150);
+        RandomGraph random = buildRandomGraph(rng, n, rng() % (n * (1 + round % 4)));
+        if (round % 2)
+            random.graph.compressAdjacency();
+        const Graph &graph = random.graph;
+        int live = graph.getUserCount();
+
+        vector<vector<int>> distance(n, vector<int>(n, -1));
+        vector<vector<double>> paths(n, vector<double>(n, 0));
+        for (int source = 0; source < n; source++)
+        {
+            if (random.removed[source])
+                continue;
+            distance[source][source] = 0;
+            paths[source][source] = 1;
+            vector<int> queue = {source};
+            for (size_t head = 0; head < queue.size(); head++)
+            {
+                int user = queue[head];
+                for (int neighbor : random.adjacency[user])
+                {
+                    if (distance[source][neighbor] < 0)
+                    {
+                        distance[source][neighbor] = distance[source][user] + 1;
+                        queue.push_back(neighbor);
+                    }
+                    if (distance[source][neighbor] == distance[source][user] + 1)
+                        paths[source][neighbor] += paths[source][user];
+                }
+            }
+        }
+
+        vector<double> expected(n, 0);
+        for (int s = 0; s < n; s++)
+        {
+            for (int t = s + 1; t < n; t++)
+            {
+                if (distance[s][t] <= 0)
+                    continue;
+                for (int via = 0; via < n; via++)
+                {
+                    if (via != s && via != t && distance[s][via] > 0 && distance[via][t] > 0 &&
+                        distance[s][via] + distance[via][t] == distance[s][t])
+                        expected[via] += paths[s][via] * paths[via][t] / paths[s][t];
+                }
+            }
+        }
+        vector<double> betweenness = GraphMetrics::betweenness(graph, n + 1);
+        failures += GraphMetrics::betweenness(graph, n / 2 + 1, 7) != GraphMetrics::betweenness(graph, n / 2 + 1, 7);
+
+        vector<double> rank(n, live ? 1.0 / live : 0);
+        for (int iteration = 0; iteration < 300; iteration++)
+        {
+            double dangling = 0;
+            for (int user = 0; user < n; user++)
+            {
+                if (!random.removed[user] && random.adjacency[user].empty())
+                    dangling += rank[user];
+            }
+            vector<double> next(n, 0);
+            for (int user = 0; user < n; user++)
+            {
+                if (random.removed[user])
+                    continue;
+                double sum = 0;
+                for (int neighbor : random.adjacency[user])
+                {
+                    sum += rank[neighbor] / random.adjacency[neighbor].size();
+                }
+                next[user] = 0.15 / live + 0.85 * (sum + dangling / live);
+            }
+            rank = next;
+        }
+        vector<double> pageRank = GraphMetrics::pageRank(graph, 0.85, 1e-13, 1000);
+        vector<double> degree = GraphMetrics::degreeCentrality(graph);
+
+        double rankSum = 0;
+        for (int user = 0; user < n; user++)
+        {
+            if (random.removed[user])
+                continue;
+            int vertex = random.vertexOf(user);
+            failures += !near(betweenness[vertex], expected[user], 1e-9);
+            failures += !near(pageRank[vertex], rank[user], 1e-9);
+            failures += !near(degree[vertex], live > 1 ? random.adjacency[user].size() / (live - 1.0) : 0, 1e-12);
+            rankSum += pageRank[vertex];
+
+            double total = 0;
+            int reached = 0;
+            for (int other = 0; other < n; other++)
+            {
+                if (distance[user][other] > 0)
+                {
+                    total += distance[user][other];
+                    reached++;
+                }
+            }
+            double closeness = total > 0 ? reached / (live - 1.0) * (reached / total) : 0;
+            failures += !near(GraphMetrics::closeness(graph, vertex), closeness, 1e-12);
+        }
+        failures += live > 0 && !near(rankSum, 1, 1e-9);
+
+        size_t k = rng() % 8;
+        vector<pair<int, double>> top = GraphMetrics::topK(graph, pageRank, k);
+        failures += top.size() != min(k, (size_t)live);
+        for (size_t i = 0; i < top.size(); i++)
+        {
+            failures += graph.isRemoved(top[i].first) || top[i].second != pageRank[top[i].first];
+            if (i > 0)
+                failures += top[i].second > top[i - 1].second;
+        }
+        for (int vertex = 0; vertex < graph.getVertexCount() && !top.empty(); vertex++)
+        {
+            failures += !graph.isRemoved(vertex) && pageRank[vertex] > top.back().second &&
+                        find_if(top.begin(), top.end(), [vertex](const pair<int, double> &entry)
+                                { return entry.first == vertex; }) == top.end();
+        }
+    }
+    return failures;
+}
+
+// Users, ID lookups and connections of a subgraph against the members it should hold
+// (user numbers, in vertex order) and the induced part of the model
+static size_t compareSubgraph(const Graph &subgraph, const vector<int> &members, const RandomGraph &random)
+{
+    size_t failures = subgraph.getUserCount() != (int)members.size() || subgraph.getVertexCount() != (int)members.size();
+    set<int> memberSet(members.begin(), members.end());
+    size_t connections = 0;
+    for (size_t i = 0; i < members.size() && !failures; i++)
+    {
+        failures += subgraph.getUserId(i) != userId(members[i]) || subgraph.getUserIndex(userId(members[i])) != (int)i;
+        set<int> neighbors, expected;
+        for (int neighbor : subgraph.getNeighbors(i))
+        {
+            neighbors.insert(members[neighbor]);
+        }
+        for (int neighbor : random.adjacency[members[i]])
+        {
+            if (memberSet.count(neighbor))
+                expected.insert(neighbor);
+        }
+        failures += neighbors != expected;
+        connections += expected.size();
+    }
+    failures += subgraph.getConnectionCount() * 2 != connections;
+    return failures;
+}
+
+// Induced subgraphs of random selections with duplicates, removed and unknown users,
+// by ID and by vertex, and ego networks against a BFS over the model; then each
+// subgraph is changed and compacted like any graph, leaving a copy intact
+static size_t checkSubgraphs()
+{
+    mt19937 rng(59);
+    size_t failures = 0;
+    for (int round = 0; round < 300; round++)
+    {
+        int n = 1 + rng() % (round < 150 ? 30 : 400);
+        RandomGraph random = buildRandomGraph(rng, n, rng() % (n * (1 + round % 5)));
+        // A hub past the degree where the graph indexes its list, whose subgraph lists
+        // are built by probing that index
+        int hub = rng() % n;
+        for (int i = round % 2 ? 150 : 0; i > 0 && !random.removed[hub]; i--)
+        {
+            int user = rng() % n;
+            if (user == hub || random.removed[user])
+                continue;
+            random.graph.addConnection(userId(hub), userId(user));
+            random.adjacency[hub].insert(user);
+            random.adjacency[user].insert(hub);
+        }
+        if (round % 3 == 1)
+            random.graph.compressAdjacency();
+        const Graph &graph = random.graph;
+
+        vector<string> ids = {"nobody"};
+        for (int i = rng() % (n + 1); i > 0; i--)
+        {
+            ids.push_back(userId(rng() % n));
+        }
+        shuffle(ids.begin(), ids.end(), rng);
+        vector<int> members;
+        set<int> seen;
+        for (const string &id : ids)
+        {
+            int user = id == "nobody" ? -1 : stoi(id.substr(1));
+            if (user >= 0 && !random.removed[user] && seen.insert(user).second)
+                members.push_back(user);
+        }
+        Graph subgraph = graph.inducedSubgraph(ids);
+        failures += compareSubgraph(subgraph, members, random);
+
+        vector<int> vertices, vertexMembers;
+        seen.clear();
+        for (int i = rng() % (graph.getVertexCount() + 1); i > 0; i--)
+        {
+            int vertex = rng() % graph.getVertexCount();
+            vertices.push_back(vertex);
+            if (!graph.isRemoved(vertex) && seen.insert(vertex).second)
+                vertexMembers.push_back(stoi(graph.getUserId(vertex).substr(1)));
+        }
+        failures += compareSubgraph(graph.inducedSubgraph(vertices), vertexMembers, random);
+
+        int center = rng() % n, hops = rng() % 4;
+        vector<int> distance(n, -1);
+        vector<int> ego;
+        if (!random.removed[center])
+        {
+            distance[center] = 0;
+            vector<int> queue = {center};
+            for (size_t head = 0; head < queue.size(); head++)
+            {
+                for (int neighbor : random.adjacency[queue[head]])
+                {
+                    if (distance[neighbor] < 0)
+                    {
+                        distance[neighbor] = distance[queue[head]] + 1;
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+            for (int user : queue)
+            {
+                if (distance[user] <= hops)
+                    ego.push_back(user);
+            }
+        }
+        Graph egoNetwork = graph.egoNetwork(userId(center), hops);
+        // BFS order within one distance may differ, so take the members in the order given
+        vector<int> egoMembers;
+        for (const string &id : egoNetwork.getUsers())
+        {
+            egoMembers.push_back(stoi(id.substr(1)));
+        }
+        failures += set<int>(egoMembers.begin(), egoMembers.end()) != set<int>(ego.begin(), ego.end());
+        failures += !ego.empty() && (egoMembers.size() != ego.size() || egoMembers[0] != center);
+        for (size_t i = 1; i < egoMembers.size() && egoMembers.size() == ego.size(); i++)
+        {
+            failures += distance[egoMembers[i]] < distance[egoMembers[i - 1]];
+        }
+        if (egoMembers.size() == ego.size())
+            failures += compareSubgraph(egoNetwork, egoMembers, random);
+
+        Graph copy = subgraph;
+        subgraph.addUser("extra");
+        if (!members.empty())
+            subgraph.addConnection("extra", userId(members[0]));
+        subgraph.compact(VertexOrder::REVERSE_CUTHILL_MCKEE);
+        failures += subgraph.getUserCount() != (int)members.size() + 1 || !subgraph.hasUser("extra");
+        failures += !members.empty() && !subgraph.areConnected("extra", userId(members[0]));
+        failures += compareSubgraph(copy, members, random);
+    }
+    return failures;
+}
+
+// Expected share of walk positions at each vertex for walks from source, by iterating
+// the distribution of the walker's position until the remaining mass is negligible
+static vector<double> exactVisitShares(const Graph &graph, int source, double restart,
+                                       const function<double(int, int)> &weight)
+{
+    int n = graph.getVertexCount();
+    vector<double> visits(n, 0.0), position(n, 0.0), next(n);
+    position[source] = 1.0;
+    for (int step = 0; step < 200; step++)
+    {
+        fill(next.begin(), next.end(), 0.0);
+        for (int vertex = 0; vertex < n; vertex++)
+        {
+            visits[vertex] += position[vertex];
+            if (position[vertex] == 0.0 || graph.isRemoved(vertex))
+                continue;
+            double total = 0;
+            for (int neighbor : graph.getNeighbors(vertex))
+            {
+                if (!graph.isRemoved(neighbor))
+                    total += weight ? weight(vertex, neighbor) : 1.0;
+            }
+            for (int neighbor : graph.getNeighbors(vertex))
+            {
+                if (!graph.isRemoved(neighbor))
+                    next[neighbor] += position[vertex] * (1 - restart) * (weight ? weight(vertex, neighbor) : 1.0) / total;
+            }
+        }
+        position.swap(next);
+    }
+
+    double sum = 0;
+    for (double count : visits)
+    {
+        sum += count;
+    }
+    for (double &count : visits)
+    {
+        count /= sum;
+    }
+    return visits;
+}
+
+// Walk estimates against exact visit shares, weighted and unweighted, plus repeatability
+// of a seed, concurrent queries on one engine and the recommendation filter
+static size_t checkPersonalizedPageRank()
+{
+    const double tolerance = 0.001;
+    mt19937 rng(3);
+    size_t failures = 0;
+    double worst = 0;
+    for (int round = 0; round < 40; round++)
+    {
+        int n = 5 + rng() % 40;
+        RandomGraph random = buildRandomGraph(rng, n, rng() % (n * 3));
+        const Graph &graph = random.graph;
+        if (round % 4 == 0)
+            random.graph.compressAdjacency();
+
+        function<double(int, int)> weight;
+        if (round % 2)
+            weight = [](int a, int b)
+            { return 1.0 + (a * 7 + b * 13) % 5; };
+        RandomWalkEngine engine(graph, weight);
+
+        int source = 0;
+        while (graph.isRemoved(source))
+            source++;
+        const double restart = 0.2;
+        vector<double> expected = exactVisitShares(graph, source, restart, weight);
+        vector<double> estimated(graph.getVertexCount(), 0.0);
+        for (const auto &[vertex, share] : engine.personalizedPageRank(source, 400000, restart, 5))
+        {
+            estimated[vertex] = share;
+        }
+        for (int vertex = 0; vertex < graph.getVertexCount(); vertex++)
+        {
+            double error = fabs(estimated[vertex] - expected[vertex]);
+            worst = max(worst, error);
+            failures += error > tolerance;
+        }
+
+        auto sequential = engine.personalizedPageRank(source, 5000, restart, 9);
+        vector<thread> readers;
+        vector<char> same(4);
+        for (size_t i = 0; i < same.size(); i++)
+        {
+            readers.emplace_back([&, i]
+                                 { same[i] = engine.personalizedPageRank(source, 5000, restart, 9) == sequential; });
+        }
+        for (thread &reader : readers)
+        {
+            reader.join();
+        }
+        failures += count(same.begin(), same.end(), 0);
+
+        for (const auto &[vertex, score] : engine.recommend(source, 3, 5000, restart, 9))
+        {
+            failures += vertex == source || graph.isRemoved(vertex) || graph.areConnected(source, vertex);
+        }
+    }
+    cout << "ppr: largest share error " << worst << " (tolerance " << tolerance << ")\n";
+    return failures;
+}
+
+// Friends of friends ranked by mutual friends, ties by user ID, straight from the graph
+static vector<string> naiveRecommendations(const Graph &graph, const string &user, size_t k)
+{
+    vector<string> users = graph.getUsers();
+    map<string, int> mutualFriends;
+    for (const string &candidate : users)
+    {
+        if (candidate == user || graph.areConnected(user, candidate))
+            continue;
+        int mutual = 0;
+        for (const string &friendId : users)
+        {
+            mutual += graph.areConnected(user, friendId) && graph.areConnected(friendId, candidate);
+        }
+        if (mutual > 0)
+            mutualFriends[candidate] = mutual;
+    }
+
+    vector<pair<string, int>> ranked(mutualFriends.begin(), mutualFriends.end());
+    stable_sort(ranked.begin(), ranked.end(), [](const pair<string, int> &a, const pair<string, int> &b)
+                { return a.second > b.second; });
+    vector<string> result;
+    for (size_t i = 0; i < ranked.size() && i < k; i++)
+    {
+        result.push_back(ranked[i].first);
+    }
+    return result;
+}
+
+// Cached top-k lookups against a naive ranking under random connection changes, user
+// removals, compaction, compression, warming and copies, then lookups running while the
+// graph is copied
+static size_t checkRecommendationCache()
+{
+    mt19937 rng(11);
+    size_t failures = 0;
+    for (int round = 0; round < 60; round++)
+    {
+        Graph graph;
+        int n = 10 + rng() % 40;
+        int ids = n + 10; // Some operations name users that do not exist
+        for (int user = 0; user < n; user++)
+        {
+            graph.addUser(userId(user));
+        }
+        for (int i = 0; i < n * 2; i++)
+        {
+            graph.addConnection(userId(rng() % n), userId(rng() % n));
+        }
+
+        for (int step = 0; step < 300; step++)
+        {
+            int operation = rng() % 12;
+            string a = userId(rng() % ids), b = userId(rng() % ids);
+            if (operation == 0)
+                graph.addConnection(a, b);
+            else if (operation == 1)
+                graph.removeConnection(a, b);
+            else if (operation == 2 && rng() % 4 == 0)
+                graph.removeUser(a);
+            else if (operation == 3 && rng() % 8 == 0)
+                graph.compact((VertexOrder)(rng() % 3));
+            else if (operation == 4 && rng() % 10 == 0)
+                graph.compressAdjacency();
+            else if (operation == 5 && rng() % 10 == 0)
+                graph.warmRecommendationCache(1 + rng() % 5);
+            else if (operation == 6 && rng() % 10 == 0)
+            {
+                Graph copy = graph;
+                graph = copy;
+            }
+            else if (graph.hasUser(a))
+            {
+                size_t k = 1 + rng() % 5;
+                failures += graph.getTopRecommendations(a, k) != naiveRecommendations(graph, a, k);
+            }
+        }
+    }
+
+    Graph graph;
+    for (int user = 0; user < 300; user++)
+    {
+        for (int j = 0; j < 5; j++)
+        {
+            graph.addConnection(userId(user), userId((user * 7 + j * 13 + 1) % 300));
+        }
+    }
+    vector<thread> readers;
+    for (int reader = 0; reader < 3; reader++)
+    {
+        readers.emplace_back([&graph, reader]
+                             {
+                                 for (int i = 0; i < 300; i++)
+                                 {
+                                     graph.getTopRecommendations(userId((i + reader * 50) % 300), 3);
+                                 } });
+    }
+    for (int i = 0; i < 20; i++)
+    {
+        Graph copy = graph;
+        failures += copy.getUserCount() != 300;
+    }
+    for (thread &reader : readers)
+    {
+        reader.join();
+    }
+    return failures;
+}
+
+static string randomText(mt19937 &rng, const string &alphabet, size_t maxLength)
+{
+    string text(rng() % (maxLength + 1), ' ');
+    for (char &c : text)
+    {
+        c = alphabet[rng() % alphabet.size()];
+    }
+    return text;
+}
+
+// Indexed fuzzy name search against verifying every name, over a small alphabet so
+// names share many grams, with distances that leave the bigram bound, the character
+// bound or neither
+static size_t checkFuzzyNameIndex()
+{
+    mt19937 rng(19);
+    size_t failures = 0;
+    for (int round = 0; round < 30; round++)
+    {
+        UserStore users;
+        int n = 1 + rng() % 2000;
+        for (int user = 0; user < n; user++)
+        {
+            users.addUser(userId(user), randomText(rng, "abcdAB ", 14));
+        }
+        FuzzyNameIndex index(users);
+
+        for (int i = 0; i < 100; i++)
+        {
+            string pattern = randomText(rng, "abcdeAB", 10);
+            int maxDistance = rng() % 6;
+            auto expected = StringSearch::fuzzySearchUsersByName(users, pattern, maxDistance);
+            auto found = index.search(pattern, maxDistance);
+            bool same = found.size() == expected.size();
+            for (size_t j = 0; same && j < found.size(); j++)
+            {
+                same = found[j].user.getUserId() == expected[j].user.getUserId() && found[j].distance == expected[j].distance;
+            }
+            failures += !same;
+        }
+    }
+    return failures;
+}
+
+// Vectorized substring search against KMP and Rabin-Karp, on texts whose lengths cross
+// the 16- and 32-byte blocks with patterns that reach into the scalar tail, mixed case
+static size_t checkSIMDSearch()
+{
+    mt19937 rng(23);
+    size_t failures = 0;
+    for (int round = 0; round < 20000; round++)
+    {
+        string text = randomText(rng, round % 2 ? "aAbB" : "abcAB -", 130);
+        string pattern = randomText(rng, "aAbBc", 1 + rng() % 40);
+        if (pattern.empty())
+            pattern = "a";
+        if (round % 3 == 0 && !text.empty())
+        {
+            size_t start = rng() % text.size();
+            pattern = text.substr(start, 1 + rng() % (text.size() - start));
+        }
+
+        StringSearch::Pattern compiled(pattern);
+        vector<size_t> expected = compiled.findAll(text, SearchAlgorithm::KMP);
+        failures += compiled.findAll(text, SearchAlgorithm::SIMD) != expected;
+        failures += compiled.findAll(text, SearchAlgorithm::RABIN_KARP) != expected;
+        failures += compiled.matches(text, SearchAlgorithm::SIMD) != !expected.empty();
+    }
+    cout << "simd: " << StringSearch::getSIMDKernelName() << " kernel\n";
+    return failures;
+}
+
+// Users with skewed locations, interests and profile keys, so some bitmaps are sparse
+// arrays and others dense, then removes a few so rows are renumbered
+static void fillRandomUsers(mt19937 &rng, UserStore &users, int n)
+{
+    for (int user = 0; user < n; user++)
+    {
+        User added = users.addUser(userId(user), "name" + to_string(user), rng() % 80,
+                                   "city" + to_string(rng() % 2 ? 0 : rng() % 6));
+        for (int interest = 0; interest < 8; interest++)
+        {
+            if (rng() % (interest + 1) == 0)
+                added.addInterest("i" + to_string(interest));
+        }
+        for (int key = 0; key < 3; key++)
+        {
+            if (rng() % (key * 3 + 2) == 0)
+                added.addProfileData("k" + to_string(key), "v");
+        }
+    }
+    for (int i = 0; i < n / 20; i++)
+    {
+        users.removeUser(userId(rng() % n));
+    }
+}
+
+// Rows matching the query by a pass over every user
+static vector<string> linearSearch(const UserStore &users, const UserQuery &query)
+{
+    vector<string> result;
+    for (size_t row = 0; row < users.size(); row++)
+    {
+        int age = users.getAges()[row];
+        bool matches = age >= query.minAge && age <= query.maxAge &&
+                       (query.location.empty() || users.getLocation(row) == query.location);
+        for (const string &interest : query.interests)
+        {
+            unsigned int id = users.getInterestDictionary().find(interest);
+            matches = matches && id != StringDictionary::NOT_FOUND && users.hasInterest(row, id);
+        }
+        for (const string &key : query.profileKeys)
+        {
+            matches = matches && users.findProfileData(row, key) != nullptr;
+        }
+        if (matches)
+            result.push_back(string(users.getIds()[row]));
+    }
+    return result;
+}
+
+// Planned bitmap intersections against a linear filter, on stores small enough for one
+// bitmap container and large enough for several, dense ones included
+static size_t checkQueryEngine()
+{
+    mt19937 rng(17);
+    size_t failures = 0;
+    for (int round = 0; round < 24; round++)
+    {
+        int n = round < 20 ? 1 + rng() % 3000 : 70000 + rng() % 90000;
+        UserStore users;
+        fillRandomUsers(rng, users, n);
+        QueryEngine engine(users);
+
+        for (int i = 0; i < (round < 20 ? 200 : 40); i++)
+        {
+            UserQuery query;
+            if (rng() % 2)
+            {
+                query.minAge = rng() % 85;
+                query.maxAge = query.minAge + rng() % (rng() % 2 ? 3 : 60);
+            }
+            if (rng() % 2)
+                query.location = "city" + to_string(rng() % 7);
+            for (int j = rng() % 4; j > 0; j--)
+            {
+                query.interests.push_back("i" + to_string(rng() % 9));
+            }
+            for (int j = rng() % 3; j > 0; j--)
+            {
+                query.profileKeys.push_back("k" + to_string(rng() % 4));
+            }
+
+            vector<string> found;
+            for (const ConstUser &user : engine.search(query))
+            {
+                found.push_back(string(user.getUserId()));
+            }
+            failures += found != linearSearch(users, query);
+        }
+    }
+    return failures;
+}
+
+// Start positions of pattern in text, ignoring case, by comparing at every position
+static vector<size_t> naiveOccurrences(string_view text, const string &pattern)
+{
+    vector<size_t> starts;
+    for (size_t start = 0; !pattern.empty() && start + pattern.size() <= text.size(); start++)
+    {
+        size_t i = 0;
+        while (i < pattern.size() && tolower((unsigned char)text[start + i]) == tolower((unsigned char)pattern[i]))
+            i++;
+        if (i == pattern.size())
+            starts.push_back(start);
+    }
+    return starts;
+}
+
+// The automaton against matching each pattern on its own, with empty, duplicate and
+// nested patterns and bytes outside every pattern, then the profile searches built on it
+// against testing every field of every user
+static size_t checkMultiPatternSearch()
+{
+    mt19937 rng(31);
+    size_t failures = 0;
+    for (int round = 0; round < 3000; round++)
+    {
+        vector<string> patterns;
+        for (int i = 1 + rng() % 12; i > 0; i--)
+        {
+            if (!patterns.empty() && rng() % 4 == 0)
+            {
+                const string &other = patterns[rng() % patterns.size()];
+                patterns.push_back(other.substr(rng() % (other.size() + 1)));
+            }
+            else
+            {
+                patterns.push_back(randomText(rng, "abcAB", 6));
+            }
+        }
+        AhoCorasick automaton(patterns);
+        string text = randomText(rng, "aAbBcx ", 80);
+
+        vector<pair<size_t, int>> expected;
+        vector<char> expectedMatched(patterns.size(), 0);
+        size_t expectedCount = 0;
+        for (size_t id = 0; id < patterns.size(); id++)
+        {
+            vector<size_t> starts = naiveOccurrences(text, patterns[id]);
+            for (size_t start : starts)
+            {
+                expected.push_back({start, (int)id});
+            }
+            expectedMatched[id] = !starts.empty();
+            expectedCount += !starts.empty();
+        }
+        vector<pair<size_t, int>> found = automaton.search(text);
+        sort(expected.begin(), expected.end());
+        sort(found.begin(), found.end());
+        failures += found != expected;
+
+        vector<char> matched(patterns.size(), 0);
+        failures += automaton.markMatches(text, matched) != expectedCount || matched != expectedMatched;
+    }
+
+    for (int round = 0; round < 20; round++)
+    {
+        UserStore users;
+        fillRandomUsers(rng, users, 1 + rng() % 2000);
+        vector<string> patterns;
+        for (int i = 1 + rng() % 6; i > 0; i--)
+        {
+            patterns.push_back(randomText(rng, "aeImnNCity0123", 3));
+        }
+
+        for (bool keywords : {false, true})
+        {
+            map<string, vector<int>> expected;
+            for (size_t row = 0; row < users.size(); row++)
+            {
+                ConstUser user = users[row];
+                vector<int> ids;
+                for (size_t id = 0; id < patterns.size(); id++)
+                {
+                    bool found = keywords && (!naiveOccurrences(user.getName(), patterns[id]).empty() ||
+                                              !naiveOccurrences(user.getLocation(), patterns[id]).empty());
+                    for (string_view interest : user.getInterests())
+                    {
+                        found = found || !naiveOccurrences(interest, patterns[id]).empty();
+                    }
+                    if (found)
+                        ids.push_back(id);
+                }
+                if (!ids.empty())
+                    expected[string(user.getUserId())] = ids;
+            }
+
+            map<string, vector<int>> found;
+            auto matches = keywords ? StringSearch::searchUsersByKeywords(users, patterns)
+                                    : StringSearch::searchUsersByInterests(users, patterns);
+            for (const auto &match : matches)
+            {
+                found[string(match.user.getUserId())] = match.patternIds;
+            }
+            failures += found != expected || matches.size() != expected.size();
+        }
+    }
+    return failures;
+}
+
+// One user as a plain record, interests in the order they were added
+struct ExpectedUser
+{
+    string name;
+    int age = 0;
+    string location;
+    vector<string> interests;
+    map<string, string> profile;
+};
+
+static size_t compareStore(const UserStore &users, const map<string, ExpectedUser> &expected)
+{
+    size_t failures = users.size() != expected.size();
+    for (size_t row = 0; row < users.size(); row++)
+    {
+        ConstUser user = users[row];
+        auto it = expected.find(string(user.getUserId()));
+        if (it == expected.end() || users.findRow(user.getUserId()) != row)
+        {
+            failures++;
+            continue;
+        }
+        const ExpectedUser &model = it->second;
+        vector<string> interests;
+        for (string_view interest : user.getInterests())
+        {
+            interests.push_back(string(interest));
+            unsigned int id = users.getInterestDictionary().find(interest);
+            failures += id == StringDictionary::NOT_FOUND || !users.hasInterest(row, id);
+        }
+        vector<pair<string, string>> profile = users.getProfileData(row);
+        sort(profile.begin(), profile.end());
+        failures += user.getName() != model.name || user.getAge() != model.age || user.getLocation() != model.location;
+        failures += interests != model.interests;
+        failures += profile != vector<pair<string, string>>(model.profile.begin(), model.profile.end());
+    }
+    for (const auto &entry : expected)
+    {
+        failures += !users.contains(entry.first);
+    }
+    return failures;
+}
+
+// Random adds, removals and edits against a map of plain records. IDs come from a small
+// pool so users are removed and added again, rows are renumbered by the swap with the
+// last row, and interest blocks are released and compacted. A copy taken halfway must
+// keep its contents while the original changes.
+static size_t checkUserStore()
+{
+    mt19937 rng(37);
+    size_t failures = 0;
+    for (int round = 0; round < 40; round++)
+    {
+        UserStore users;
+        map<string, ExpectedUser> model;
+        int ids = 1 + rng() % (round % 4 == 0 ? 20 : 600);
+        UserStore copy;
+        map<string, ExpectedUser> copyModel;
+        for (int step = 0; step < 3000; step++)
+        {
+            string id = userId(rng() % ids);
+            size_t row = users.findRow(id);
+            bool present = model.count(id) != 0;
+            failures += (row != UserStore::NOT_FOUND) != present;
+
+            int operation = rng() % 10;
+            if (!present)
+            {
+                if (operation < 6)
+                {
+                    ExpectedUser &added = model[id];
+                    added.name = randomText(rng, "abc", 8);
+                    added.age = rng() % 100;
+                    added.location = "city" + to_string(rng() % 5);
+                    users.addUser(id, added.name, added.age, added.location);
+                }
+                else
+                {
+                    failures += users.removeUser(id);
+                }
+            }
+            else if (operation < 2)
+            {
+                failures += !users.removeUser(id);
+                model.erase(id);
+            }
+            else if (operation < 4)
+            {
+                string interest = "i" + to_string(rng() % 10);
+                vector<string> &interests = model[id].interests;
+                users[row].addInterest(interest);
+                if (find(interests.begin(), interests.end(), interest) == interests.end())
+                    interests.push_back(interest);
+            }
+            else if (operation < 6)
+            {
+                string interest = "i" + to_string(rng() % 10);
+                vector<string> &interests = model[id].interests;
+                users[row].removeInterest(interest);
+                interests.erase(remove(interests.begin(), interests.end(), interest), interests.end());
+            }
+            else if (operation < 7)
+            {
+                string key = "k" + to_string(rng() % 4), value = randomText(rng, "xyz", 4);
+                users[row].addProfileData(key, value);
+                model[id].profile[key] = value;
+            }
+            else if (operation < 8)
+            {
+                model[id].name = randomText(rng, "abc", 8);
+                users[row].setName(model[id].name);
+            }
+            else if (operation < 9)
+            {
+                model[id].age = rng() % 100;
+                users[row].setAge(model[id].age);
+            }
+            else
+            {
+                model[id].location = "city" + to_string(rng() % 5);
+                users[row].setLocation(model[id].location);
+            }
+
+            if (step % 250 == 0)
+                failures += compareStore(users, model);
+            if (step == 1500)
+            {
+                copy = users;
+                copyModel = model;
+            }
+        }
+        failures += compareStore(users, model);
+        failures += compareStore(copy, copyModel);
+    }
+    return failures;
+}
+
+// The ID hash table against a map under the calls UserStore makes: appends, and removals
+// that move the last row into the hole. IDs repeat, so later duplicates stay unindexed,
+// and the pool is large enough for long probe clusters that wrap around the table.
+static size_t checkUserIdIndex()
+{
+    mt19937 rng(41);
+    size_t failures = 0;
+    for (int round = 0; round < 30; round++)
+    {
+        StringColumn ids;
+        UserIdIndex index;
+        map<string, unsigned int> expected; // ID -> indexed row
+        int pool = 1 + rng() % (round % 3 == 0 ? 50 : 5000);
+        if (round % 5 == 0)
+            index.reserve(rng() % 1000);
+        for (int step = 0; step < 20000; step++)
+        {
+            if (ids.empty() || rng() % 5 < 3)
+            {
+                string id = userId(rng() % pool);
+                ids.push_back(id);
+                bool added = expected.insert({id, ids.size() - 1}).second;
+                failures += index.insert(ids.size() - 1, ids) != added;
+            }
+            else
+            {
+                unsigned int row = rng() % ids.size(), last = ids.size() - 1;
+                auto erased = expected.find(string(ids[row]));
+                if (erased != expected.end() && erased->second == row)
+                    expected.erase(erased);
+                index.erase(row, ids);
+                if (row != last)
+                {
+                    auto moved = expected.find(string(ids[last]));
+                    if (moved != expected.end() && moved->second == last)
+                        moved->second = row;
+                    index.relabel(last, row, ids);
+                }
+                ids.swapRemove(row);
+            }
+
+            if (step % 1000 == 0 || rng() % 200 == 0)
+            {
+                failures += index.size() != expected.size();
+                for (int user = 0; user < pool; user++)
+                {
+                    auto it = expected.find(userId(user));
+                    failures += index.find(userId(user), ids) != (it == expected.end() ? UserIdIndex::NOT_FOUND : it->second);
+                }
+            }
+        }
+        index.clear();
+        failures += index.size() != 0 || index.find(userId(0), ids) != UserIdIndex::NOT_FOUND;
+    }
+    return failures;
+}
+
+// Users and connections one version should hold
+struct ExpectedVersion
+{
+    set<int> users;
+    set<pair<int, int>> connections; // (smaller, larger) user number
+};
+
+static size_t compareVersion(const NetworkSnapshot &snapshot, const ExpectedVersion &expected, int ids)
+{
+    const Graph &graph = snapshot.graph;
+    size_t failures = 0;
+    failures += graph.getUserCount() != (int)expected.users.size() || snapshot.users->size() != expected.users.size();
+    failures += graph.getConnectionCount() != expected.connections.size();
+    for (int user = 0; user < ids; user++)
+    {
+        bool present = expected.users.count(user) != 0;
+        failures += graph.hasUser(userId(user)) != present || snapshot.users->contains(userId(user)) != present;
+        if (!present)
+            continue;
+        int vertex = graph.getUserIndex(userId(user));
+        failures += graph.getUserId(vertex) != userId(user);
+
+        set<int> neighbors;
+        for (int neighbor : graph.getNeighbors(vertex))
+        {
+            const string &id = graph.getUserId(neighbor);
+            if (!graph.isRemoved(neighbor))
+                neighbors.insert(id.size() > 1 ? stoi(id.substr(1)) : -1);
+        }
+        set<int> expectedNeighbors;
+        for (const auto &[a, b] : expected.connections)
+        {
+            if (a == user)
+                expectedNeighbors.insert(b);
+            else if (b == user)
+                expectedNeighbors.insert(a);
+        }
+        failures += neighbors != expectedNeighbors;
+    }
+    return failures;
+}
+
+// Versions published by random batches, compactions and compressions against a plain
+// model of each, checked again once later versions exist and by a reader running during
+// the commits, so a change leaking into the chunks, ID index or user store a version
+// shares with its predecessor is caught
+static size_t checkVersionedNetwork()
+{
+    mt19937 rng(29);
+    size_t failures = 0;
+    for (int round = 0; round < 12; round++)
+    {
+        VersionedNetwork network;
+        int ids = 100 + rng() % (round < 8 ? 600 : 3000); // Enough users for several chunks
+        ExpectedVersion model;
+        vector<pair<shared_ptr<const NetworkSnapshot>, ExpectedVersion>> versions;
+        versions.push_back({network.snapshot(), model});
+
+        // A reader keeps checking one version while later ones are committed
+        atomic<bool> done(false);
+        atomic<size_t> readerFailures(0);
+        thread reader;
+        for (int step = 0; step < 120; step++)
+        {
+            if (step == 10)
+            {
+                auto pinned = make_shared<pair<shared_ptr<const NetworkSnapshot>, ExpectedVersion>>(network.snapshot(), model);
+                reader = thread([pinned, ids, &done, &readerFailures]
+                                {
+                                    do
+                                    {
+                                        readerFailures += compareVersion(*pinned->first, pinned->second, ids);
+                                    } while (!done); });
+            }
+
+            int kind = rng() % 20;
+            if (kind == 0)
+            {
+                network.compact((VertexOrder)(rng() % 3));
+            }
+            else if (kind == 1)
+            {
+                network.compressAdjacency();
+            }
+            else
+            {
+                // Mostly valid operations on the users the batch has so far, and in one
+                // batch in eight a random one that may make the whole batch fail
+                NetworkUpdate update;
+                ExpectedVersion changed = model;
+                bool valid = true;
+                bool risky = rng() % 8 == 0;
+                for (int i = 1 + rng() % (step < 5 ? 400 : 20); i > 0; i--)
+                {
+                    vector<int> present(changed.users.begin(), changed.users.end());
+                    auto pick = [&]()
+                    { return present.empty() || (risky && rng() % 4 == 0) ? (int)(rng() % ids) : present[rng() % present.size()]; };
+                    int operation = rng() % 10;
+                    if (operation < 3 || present.empty())
+                    {
+                        int a = rng() % ids;
+                        while (!risky && changed.users.count(a) && (int)changed.users.size() < ids)
+                            a = rng() % ids;
+                        update.addUser(userId(a), "name" + to_string(a));
+                        valid = valid && changed.users.insert(a).second;
+                    }
+                    else if (operation < 8)
+                    {
+                        int a = pick(), b = pick();
+                        update.addConnection(userId(a), userId(b));
+                        valid = valid && changed.users.count(a) && changed.users.count(b);
+                        if (a != b)
+                            changed.connections.insert({min(a, b), max(a, b)});
+                    }
+                    else if (operation < 9)
+                    {
+                        int a = pick(), b = pick();
+                        update.removeConnection(userId(a), userId(b));
+                        changed.connections.erase({min(a, b), max(a, b)});
+                    }
+                    else
+                    {
+                        int a = pick();
+                        update.removeUser(userId(a));
+                        valid = valid && changed.users.erase(a);
+                        for (auto it = changed.connections.begin(); it != changed.connections.end();)
+                        {
+                            it = it->first == a || it->second == a ? changed.connections.erase(it) : next(it);
+                        }
+                    }
+                }
+
+                try
+                {
+                    network.commit(update);
+                    failures += !valid;
+                    model = changed;
+                }
+                catch (const runtime_error &)
+                {
+                    failures += valid;
+                }
+            }
+            if (rng() % 4 == 0)
+                versions.push_back({network.snapshot(), model});
+        }
+        versions.push_back({network.snapshot(), model});
+        done = true;
+        reader.join();
+        failures += readerFailures;
+
+        for (const auto &[snapshot, expected] : versions)
+        {
+            failures += compareVersion(*snapshot, expected, ids);
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    const map<string, function<size_t()>> sections = {
+        {"centrality", checkCentrality},
+        {"compressed", checkCompressedAdjacency},
+        {"coreness", checkCoreness},
+        {"fuzzy", checkFuzzyNameIndex},
+        {"idindex", checkUserIdIndex},
+        {"multipattern", checkMultiPatternSearch},
+        {"ppr", checkPersonalizedPageRank},
+        {"query", checkQueryEngine},
+        {"recommendations", checkRecommendationCache},
+        {"simd", checkSIMDSearch},
+        {"subgraph", checkSubgraphs},
+        {"triangles", checkTriangles},
+        {"userstore", checkUserStore},
+        {"versions", checkVersionedNetwork},
+    };
+
+    vector<string> selected(argv + 1, argv + argc);
+    if (selected.empty())
+    {
+        for (const auto &section : sections)
+        {
+            selected.push_back(section.first);
+        }
+    }
+
+    size_t failures = 0;
+    for (const string &name : selected)
+    {
+        auto it = sections.find(name);
+        if (it == sections.end())
+        {
+            cerr << "unknown section " << name << '\n';
+            return 2;
+        }
+        size_t sectionFailures = it->second();
+        cout << name << ": " << (sectionFailures == 0 ? "ok" : to_string(sectionFailures) + " failures") << '\n';
+        failures += sectionFailures;
+    }
+    return failures == 0 ? 0 : 1;
+}